@@ -0,0 +1,132 @@
+#ifndef _ARENA_HPP
+#define _ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <type_traits>
+
+namespace Lox
+{
+    // A fixed-size run of node pointers that lives inside an Arena.
+    template <typename T>
+    class NodeList
+    {
+    private:
+        T *items;
+        size_t count;
+
+    public:
+        NodeList(void) : items(nullptr), count(0){};
+        NodeList(T *items, size_t count) : items(items), count(count){};
+
+        T *begin(void) const { return items; };
+        T *end(void) const { return items + count; };
+        size_t size(void) const { return count; };
+        bool empty(void) const { return count == 0; };
+        T operator[](size_t index) const { return items[index]; };
+    };
+
+    // Owns every node and token of a parse. Allocation is a pointer bump
+    // into large blocks, and everything is released at once when the arena
+    // goes away, so nodes refer to each other through plain pointers.
+    class Arena
+    {
+    private:
+        static const size_t BLOCK_SIZE = 64 * 1024;
+
+        struct Destructor
+        {
+            void *object;
+            void (*destroy)(void *);
+        };
+
+        std::vector<char *> blocks;
+        std::vector<Destructor> destructors;
+        char *next;
+        size_t remaining;
+
+        void *allocate(size_t size, size_t align)
+        {
+            size_t padding = (align - (reinterpret_cast<uintptr_t>(next) % align)) % align;
+
+            if (next == nullptr || padding + size > remaining)
+            {
+                size_t blockSize = size + align > BLOCK_SIZE ? size + align : BLOCK_SIZE;
+                next = static_cast<char *>(std::malloc(blockSize));
+
+                if (next == nullptr)
+                    throw std::bad_alloc();
+
+                blocks.push_back(next);
+                remaining = blockSize;
+                padding = (align - (reinterpret_cast<uintptr_t>(next) % align)) % align;
+            }
+
+            void *result = next + padding;
+            next += padding + size;
+            remaining -= padding + size;
+            return result;
+        }
+
+    public:
+        Arena(void) : next(nullptr), remaining(0){};
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena(void)
+        {
+            for (auto it = destructors.rbegin(); it != destructors.rend(); it++)
+                it->destroy(it->object);
+
+            for (char *block : blocks)
+                std::free(block);
+        }
+
+        template <typename T, typename... Args>
+        T *make(Args &&...args)
+        {
+            T *object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+            if (!std::is_trivially_destructible<T>::value)
+                destructors.push_back(Destructor{object, [](void *o)
+                                                 { static_cast<T *>(o)->~T(); }});
+            return object;
+        }
+
+        // Copies source text into the arena, so tokens can keep views into it.
+        std::string_view text(const std::string &chars)
+        {
+            char *copy = static_cast<char *>(allocate(chars.size() + 1, 1));
+
+            std::memcpy(copy, chars.data(), chars.size());
+            copy[chars.size()] = '\0';
+            return std::string_view(copy, chars.size());
+        }
+
+        template <typename T>
+        NodeList<T> list(const std::vector<T> &items)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "NodeList items are never destroyed");
+
+            if (items.empty())
+                return NodeList<T>();
+
+            T *array = static_cast<T *>(allocate(sizeof(T) * items.size(), alignof(T)));
+
+            for (size_t i = 0; i < items.size(); i++)
+                new (&array[i]) T(items[i]);
+
+            return NodeList<T>(array, items.size());
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef _ARGUMENTS_HPP
+#define _ARGUMENTS_HPP
+
+#include <ast/value.hpp>
+#include <cstddef>
+
+namespace Lox
+{
+    // The arguments of a call: a run of Values on whichever stack the caller
+    // evaluated them on. The caller keeps them rooted until the call returns.
+    class Arguments
+    {
+    private:
+        const Value *values;
+        size_t count;
+
+    public:
+        Arguments(void) : values(nullptr), count(0){};
+        Arguments(const Value *values, size_t count) : values(values), count(count){};
+
+        const Value *begin(void) const { return values; };
+        const Value *end(void) const { return values + count; };
+        size_t size(void) const { return count; };
+        const Value &operator[](size_t index) const { return values[index]; };
+    };
+}
+
+#endif
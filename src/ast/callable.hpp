@@ -1,21 +1,22 @@
 #ifndef _CALLABLE_H
 #define _CALLABLE_H
 
+#include <ast/object.hpp>
 #include <ast/value.hpp>
+#include <ast/arguments.hpp>
 #include <interpreter/interpreter.hpp>
 #include <memory>
-#include <list>
 #include <any>
 #include <iostream>
 
 namespace Lox
 {
-    class LoxCallable
+    class LoxCallable : public Object
     {
     public:
         virtual ~LoxCallable(void){};
         virtual long unsigned int arity(void) const = 0;
-        virtual Value call(const Interpreter &interpreter, const std::list<Value> &arguments) = 0;
+        virtual Value call(const Interpreter &interpreter, Arguments arguments) = 0;
         virtual std::string toString(void) const = 0;
     };
 }
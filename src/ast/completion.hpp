@@ -0,0 +1,50 @@
+#ifndef _COMPLETION_HPP
+#define _COMPLETION_HPP
+
+#include <ast/value.hpp>
+
+namespace Lox
+{
+    enum class CompletionType
+    {
+        NORMAL,
+        RETURN,
+        TAIL_CALL
+    };
+
+    // How a statement finished. A return statement completes with RETURN and
+    // the returned value, and every enclosing statement passes that on until
+    // the function call that owns it. A tail call completes with TAIL_CALL
+    // and the callee instead, which that function call then runs in its
+    // place.
+    class Completion
+    {
+    public:
+        CompletionType type;
+        Value value;
+
+        Completion(void) : type(CompletionType::NORMAL)
+        {
+        }
+
+        explicit Completion(const Value &value) : type(CompletionType::RETURN), value(value)
+        {
+        }
+
+        Completion(CompletionType type, const Value &value) : type(type), value(value)
+        {
+        }
+
+        bool isReturn(void) const
+        {
+            return type != CompletionType::NORMAL;
+        }
+
+        bool isTailCall(void) const
+        {
+            return type == CompletionType::TAIL_CALL;
+        }
+    };
+}
+
+#endif
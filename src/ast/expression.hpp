@@ -3,9 +3,11 @@
 
 #include <environment/environment.hpp>
 #include <scanner/token.hpp>
+#include <ast/value.hpp>
+#include <ast/arena.hpp>
+#include <ast/quickening.hpp>
 #include <memory>
 #include <utility>
-#include <any>
 
 namespace Lox
 {
@@ -26,18 +28,18 @@ namespace Lox
 	{
 	public:
 		virtual ~ExpressionVisitor(void) {}
-		virtual std::any visitAssignExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Assign> expr) const = 0;
-		virtual std::any visitBinaryExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Binary> expr) const = 0;
-		virtual std::any visitCallExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Call> expr) const = 0;
-		virtual std::any visitGetExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Get> expr) const = 0;
-		virtual std::any visitGroupingExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Grouping> expr) const = 0;
-		virtual std::any visitLiteralExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Literal> expr) const = 0;
-		virtual std::any visitLogicalExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Logical> expr) const = 0;
-		virtual std::any visitSetExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Set> expr) const = 0;
-		virtual std::any visitSuperExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Super> expr) const = 0;
-		virtual std::any visitThisExpression(std::shared_ptr<Environment> env, std::shared_ptr<const This> expr) const = 0;
-		virtual std::any visitUnaryExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Unary> expr) const = 0;
-		virtual std::any visitVariableExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Variable> expr) const = 0;
+		virtual Value visitAssignExpression(Environment *env, const Assign *expr) const = 0;
+		virtual Value visitBinaryExpression(Environment *env, const Binary *expr) const = 0;
+		virtual Value visitCallExpression(Environment *env, const Call *expr) const = 0;
+		virtual Value visitGetExpression(Environment *env, const Get *expr) const = 0;
+		virtual Value visitGroupingExpression(Environment *env, const Grouping *expr) const = 0;
+		virtual Value visitLiteralExpression(Environment *env, const Literal *expr) const = 0;
+		virtual Value visitLogicalExpression(Environment *env, const Logical *expr) const = 0;
+		virtual Value visitSetExpression(Environment *env, const Set *expr) const = 0;
+		virtual Value visitSuperExpression(Environment *env, const Super *expr) const = 0;
+		virtual Value visitThisExpression(Environment *env, const This *expr) const = 0;
+		virtual Value visitUnaryExpression(Environment *env, const Unary *expr) const = 0;
+		virtual Value visitVariableExpression(Environment *env, const Variable *expr) const = 0;
 	};
 
 	class Expression
@@ -45,187 +47,196 @@ namespace Lox
 	public:
 		virtual ~Expression(void){};
 		Expression(void){};
-		virtual std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const = 0;
+		virtual Value accept(Environment *env, const ExpressionVisitor &visitor) const = 0;
 	};
 
-	class Assign : public Expression, public std::enable_shared_from_this<Assign>
+	class Assign : public Expression
 	{
 	public:
-		std::shared_ptr<const Token> name;
-		std::shared_ptr<const Expression> value;
+		const Token *name;
+		const Expression *value;
+		mutable Slot slot{};
+		mutable int upvalue{};
 
-		Assign(std::shared_ptr<const Token> name, std::shared_ptr<const Expression> value)
+		Assign(const Token *name, const Expression *value)
 			: name(name), value(value){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitAssignExpression(env, shared_from_this());
+			return visitor.visitAssignExpression(env, this);
 		}
 	};
 
-	class Binary : public Expression, public std::enable_shared_from_this<Binary>
+	class Binary : public Expression
 	{
 	public:
-		std::shared_ptr<const Expression> left;
-		std::shared_ptr<const Token> op;
-		std::shared_ptr<const Expression> right;
-
-		Binary(std::shared_ptr<const Expression> left, std::shared_ptr<const Token> op, std::shared_ptr<const Expression> right)
+		const Expression *left;
+		const Token *op;
+		const Expression *right;
+		mutable BinaryKind kind{};
+		mutable int seen{};
+		mutable int hits{};
+
+		Binary(const Expression *left, const Token *op, const Expression *right)
 			: left(left), op(op), right(right){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitBinaryExpression(env, shared_from_this());
+			return visitor.visitBinaryExpression(env, this);
 		}
 	};
 
-	class Call : public Expression, public std::enable_shared_from_this<Call>
+	class Call : public Expression
 	{
 	public:
-		std::shared_ptr<const Expression> callee;
-		std::shared_ptr<const Token> paren;
-		std::shared_ptr<std::list<std::shared_ptr<Expression>>> arguments;
+		const Expression *callee;
+		const Token *paren;
+		NodeList<const Expression *> arguments;
 
-		Call(std::shared_ptr<const Expression> callee, std::shared_ptr<const Token> paren, std::shared_ptr<std::list<std::shared_ptr<Expression>>> arguments)
+		Call(const Expression *callee, const Token *paren, NodeList<const Expression *> arguments)
 			: callee(callee), paren(paren), arguments(arguments){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitCallExpression(env, shared_from_this());
+			return visitor.visitCallExpression(env, this);
 		}
 	};
 
-	class Get : public Expression, public std::enable_shared_from_this<Get>
+	class Get : public Expression
 	{
 	public:
-		std::shared_ptr<const Expression> obj;
-		std::shared_ptr<const Token> name;
+		const Expression *obj;
+		const Token *name;
 
-		Get(std::shared_ptr<const Expression> obj, std::shared_ptr<const Token> name)
+		Get(const Expression *obj, const Token *name)
 			: obj(obj), name(name){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitGetExpression(env, shared_from_this());
+			return visitor.visitGetExpression(env, this);
 		}
 	};
 
-	class Grouping : public Expression, public std::enable_shared_from_this<Grouping>
+	class Grouping : public Expression
 	{
 	public:
-		std::shared_ptr<const Expression> expression;
+		const Expression *expression;
 
-		Grouping(std::shared_ptr<const Expression> expression)
+		Grouping(const Expression *expression)
 			: expression(expression){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitGroupingExpression(env, shared_from_this());
+			return visitor.visitGroupingExpression(env, this);
 		}
 	};
 
-	class Literal : public Expression, public std::enable_shared_from_this<Literal>
+	class Literal : public Expression
 	{
 	public:
-		std::shared_ptr<const TokenType> type;
-		std::shared_ptr<const std::any> value;
+		Value value;
 
-		Literal(std::shared_ptr<const TokenType> type, std::shared_ptr<const std::any> value)
-			: type(type), value(value){};
+		Literal(Value value)
+			: value(value){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitLiteralExpression(env, shared_from_this());
+			return visitor.visitLiteralExpression(env, this);
 		}
 	};
 
-	class Logical : public Expression, public std::enable_shared_from_this<Logical>
+	class Logical : public Expression
 	{
 	public:
-		std::shared_ptr<const Expression> left;
-		std::shared_ptr<const Token> op;
-		std::shared_ptr<const Expression> right;
+		const Expression *left;
+		const Token *op;
+		const Expression *right;
 
-		Logical(std::shared_ptr<const Expression> left, std::shared_ptr<const Token> op, std::shared_ptr<const Expression> right)
+		Logical(const Expression *left, const Token *op, const Expression *right)
 			: left(left), op(op), right(right){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitLogicalExpression(env, shared_from_this());
+			return visitor.visitLogicalExpression(env, this);
 		}
 	};
 
-	class Set : public Expression, public std::enable_shared_from_this<Set>
+	class Set : public Expression
 	{
 	public:
-		std::shared_ptr<const Expression> obj;
-		std::shared_ptr<const Token> name;
-		std::shared_ptr<const Expression> value;
+		const Expression *obj;
+		const Token *name;
+		const Expression *value;
 
-		Set(std::shared_ptr<const Expression> obj, std::shared_ptr<const Token> name, std::shared_ptr<const Expression> value)
+		Set(const Expression *obj, const Token *name, const Expression *value)
 			: obj(obj), name(name), value(value){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitSetExpression(env, shared_from_this());
+			return visitor.visitSetExpression(env, this);
 		}
 	};
 
-	class Super : public Expression, public std::enable_shared_from_this<Super>
+	class Super : public Expression
 	{
 	public:
-		std::shared_ptr<const Token> keyword;
-		std::shared_ptr<const Token> method;
+		const Token *keyword;
+		const Token *method;
 
-		Super(std::shared_ptr<const Token> keyword, std::shared_ptr<const Token> method)
+		Super(const Token *keyword, const Token *method)
 			: keyword(keyword), method(method){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitSuperExpression(env, shared_from_this());
+			return visitor.visitSuperExpression(env, this);
 		}
 	};
 
-	class This : public Expression, public std::enable_shared_from_this<This>
+	class This : public Expression
 	{
 	public:
-		std::shared_ptr<const Token> keyword;
+		const Token *keyword;
 
-		This(std::shared_ptr<const Token> keyword)
+		This(const Token *keyword)
 			: keyword(keyword){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitThisExpression(env, shared_from_this());
+			return visitor.visitThisExpression(env, this);
 		}
 	};
 
-	class Unary : public Expression, public std::enable_shared_from_this<Unary>
+	class Unary : public Expression
 	{
 	public:
-		std::shared_ptr<const Token> op;
-		std::shared_ptr<const Expression> right;
+		const Token *op;
+		const Expression *right;
+		mutable UnaryKind kind{};
+		mutable int seen{};
+		mutable int hits{};
 
-		Unary(std::shared_ptr<const Token> op, std::shared_ptr<const Expression> right)
+		Unary(const Token *op, const Expression *right)
 			: op(op), right(right){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitUnaryExpression(env, shared_from_this());
+			return visitor.visitUnaryExpression(env, this);
 		}
 	};
 
-	class Variable : public Expression, public std::enable_shared_from_this<Variable>
+	class Variable : public Expression
 	{
 	public:
-		std::shared_ptr<const Token> name;
+		const Token *name;
+		mutable Slot slot{};
+		mutable int upvalue{};
 
-		Variable(std::shared_ptr<const Token> name)
+		Variable(const Token *name)
 			: name(name){};
 
-		std::any accept(std::shared_ptr<Environment> env, const ExpressionVisitor &visitor) const override
+		Value accept(Environment *env, const ExpressionVisitor &visitor) const override
 		{
-			return visitor.visitVariableExpression(env, shared_from_this());
+			return visitor.visitVariableExpression(env, this);
 		}
 	};
 
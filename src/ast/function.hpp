@@ -3,10 +3,11 @@
 
 #include <ast/callable.hpp>
 #include <ast/value.hpp>
-#include <ast/return_value.hpp>
+#include <ast/completion.hpp>
 #include <interpreter/interpreter.hpp>
+#include <heap/heap.hpp>
 #include <memory>
-#include <list>
+#include <vector>
 #include <any>
 
 namespace Lox
@@ -14,46 +15,71 @@ namespace Lox
     class LoxFunction : public LoxCallable
     {
     private:
-        std::shared_ptr<const Function> declaration;
-        std::shared_ptr<Environment> closure;
+        const Function *declaration;
+        // Only the variables the function refers to, not whole scopes.
+        const std::vector<Upvalue *> upvalues;
+
+        Completion run(const Interpreter &interpreter, Arguments args)
+        {
+            Completion completion;
+
+            if (declaration->lazy != nullptr)
+                declaration = declaration->lazy->parse(*declaration->name);
+
+            if (interpreter.jit.call(declaration, upvalues.data(), args, completion))
+                return completion;
+
+            Frame frame = Frame(interpreter.stack, nullptr, declaration->scopeSize);
+            frame.environment->setUpvalues(upvalues.data());
+
+            for (auto &arg : args)
+                frame.environment->define(arg);
+
+            return interpreter.executeBlock(frame.environment, declaration->body);
+        }
 
     public:
         LoxFunction(void) = delete;
 
-        LoxFunction(std::shared_ptr<const Function> declaration, std::shared_ptr<Environment> closure)
-            : declaration(declaration), closure(closure)
+        LoxFunction(const Function *declaration, std::vector<Upvalue *> upvalues)
+            : declaration(declaration), upvalues(std::move(upvalues))
         {
         }
 
         virtual long unsigned int arity(void) const override
         {
-            return declaration->params->size();
+            return declaration->params.size();
         }
 
-        virtual Value call(const Interpreter &interpreter, const std::list<Value> &args) override
+        virtual Value call(const Interpreter &interpreter, Arguments args) override
         {
-            std::shared_ptr<Environment> env = std::make_shared<Environment>(closure);
-            std::list<std::shared_ptr<Token>> &params = *declaration->params;
-            auto param = params.begin();
-            auto arg = args.begin();
+            // Tail calls come back here with their callee and arguments on the
+            // argument stack, and run in this loop instead of a nested call.
+            ArgumentStack::Scope scope = ArgumentStack::Scope(interpreter.arguments);
+            LoxFunction *function = this;
 
-            for (; param != params.end(); param++, arg++)
-                env->define((*param)->lexeme, *arg);
-
-            try
-            {
-                interpreter.executeBlock(env, declaration->body);
-            }
-            catch (ReturnValue &rv)
+            for (;;)
             {
-                return rv.value;
+                size_t mark = interpreter.arguments.size();
+                Completion completion = function->run(interpreter, args);
+
+                if (!completion.isTailCall())
+                    return completion.value;
+
+                function = static_cast<LoxFunction *>(completion.value.asObject());
+                args = scope.replace(mark);
             }
-            return Value(ValueType::NIL, nullptr);
+        }
+
+        void trace(Heap &heap) const override
+        {
+            for (Upvalue *upvalue : upvalues)
+                heap.mark(upvalue);
         }
 
         std::string toString(void) const
         {
-            return "<fn " + declaration->name->lexeme + ">";
+            return "<fn " + std::string(declaration->name->lexeme) + ">";
         }
     };
 }
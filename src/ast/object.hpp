@@ -0,0 +1,71 @@
+#ifndef _OBJECT_HPP
+#define _OBJECT_HPP
+
+#include <string>
+#include <cstdint>
+#include <utility>
+
+namespace Lox
+{
+    class Heap;
+
+    // Anything owned by the garbage collector. The heap threads every live
+    // object on one list, and trace() reports the objects this one refers to.
+    class HeapObject
+    {
+    public:
+        bool marked;
+        uint32_t size;
+        HeapObject *next;
+
+        HeapObject(void) : marked(false), size(0), next(nullptr){};
+        virtual ~HeapObject(void){};
+        virtual void trace(Heap &) const {};
+    };
+
+    class Object : public HeapObject
+    {
+    public:
+        virtual std::string toString(void) const = 0;
+    };
+
+    // Text, or the concatenation of two other strings until something needs
+    // the characters. Appending to a long string is then constant time, and
+    // the rope is flattened once, when it is printed or compared. Only flat
+    // strings are interned.
+    class LoxString : public Object
+    {
+    private:
+        mutable std::string chars;
+        mutable const LoxString *left;
+        mutable const LoxString *right;
+
+        void flatten(void) const;
+
+    public:
+        const size_t length;
+        bool interned;
+
+        LoxString(std::string chars)
+            : chars(std::move(chars)), left(nullptr), right(nullptr), length(this->chars.size()), interned(false){};
+        LoxString(const LoxString *left, const LoxString *right)
+            : chars(), left(left), right(right), length(left->length + right->length), interned(false){};
+
+        const std::string &text(void) const
+        {
+            if (left != nullptr)
+                flatten();
+
+            return chars;
+        }
+
+        void trace(Heap &heap) const override;
+
+        std::string toString(void) const override
+        {
+            return text();
+        }
+    };
+}
+
+#endif
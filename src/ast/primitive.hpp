@@ -4,8 +4,8 @@
 #include <ast/callable.hpp>
 #include <ast/value.hpp>
 #include <interpreter/interpreter.hpp>
+#include <ast/arguments.hpp>
 #include <memory>
-#include <list>
 #include <any>
 #include <chrono>
 #include <sys/time.h>
@@ -21,22 +21,22 @@ namespace Lox
     class LoxPrimitiveFn
     {
     public:
-        static const Value clock(const std::list<Value> &)
+        static const Value clock(Arguments)
         {
             double now = (double)duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-            return Value(ValueType::NUMBER, (double)(now / 1000.0f));
+            return Value((double)(now / 1000.0f));
         };
     };
 
     class LoxPrimitive : public LoxCallable
     {
     private:
-        const Value (*func)(const std::list<Value> &);
+        const Value (*func)(Arguments);
 
     public:
         LoxPrimitive(void) = delete;
 
-        LoxPrimitive(const Value (*func)(const std::list<Value> &)) : func(func)
+        LoxPrimitive(const Value (*func)(Arguments)) : func(func)
         {
         }
 
@@ -45,7 +45,12 @@ namespace Lox
             return 0;
         }
 
-        virtual Value call(const Interpreter &, const std::list<Value> &args) override
+        virtual Value call(const Interpreter &, Arguments args) override
+        {
+            return invoke(args);
+        }
+
+        Value invoke(Arguments args) const
         {
             return func(args);
         }
@@ -0,0 +1,46 @@
+#ifndef _QUICKENING_HPP
+#define _QUICKENING_HPP
+
+namespace Lox
+{
+    // How many times an operator node runs generically, recording the
+    // operand types it sees, before it specialises itself.
+    const int QUICKEN_AFTER = 2;
+
+    enum OperandTypes
+    {
+        SEEN_NUMBERS = 1,
+        SEEN_STRINGS = 2,
+        SEEN_OTHER = 4
+    };
+
+    // The form a Binary node currently runs as. UNSEEN nodes are still
+    // warming up, GENERIC ones either saw mixed types or had a specialised
+    // form fail its type check, and stay generic.
+    enum class BinaryKind
+    {
+        UNSEEN,
+        GENERIC,
+        STRING_CONCAT,
+        NUMBER_ADD,
+        NUMBER_SUBTRACT,
+        NUMBER_MULTIPLY,
+        NUMBER_DIVIDE,
+        NUMBER_GREATER,
+        NUMBER_GREATER_EQUAL,
+        NUMBER_LESS,
+        NUMBER_LESS_EQUAL,
+        NUMBER_EQUAL,
+        NUMBER_NOT_EQUAL
+    };
+
+    enum class UnaryKind
+    {
+        UNSEEN,
+        GENERIC,
+        NOT,
+        NUMBER_NEGATE
+    };
+}
+
+#endif
@@ -4,9 +4,13 @@
 #include <environment/environment.hpp>
 #include <scanner/token.hpp>
 #include <ast/expression.hpp>
+#include <ast/completion.hpp>
+#include <ast/arena.hpp>
+#include <jit/native_code.hpp>
+#include <parser/lazy_body.hpp>
 #include <memory>
 #include <utility>
-#include <any>
+#include <vector>
 
 namespace Lox
 {
@@ -24,15 +28,15 @@ namespace Lox
 	{
 	public:
 		virtual ~StatementVisitor(void) {}
-		virtual std::any visitBlockStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Block> expr) const = 0;
-		virtual std::any visitClassStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Class> expr) const = 0;
-		virtual std::any visitExpressionStatementStatement(std::shared_ptr<Environment> env, std::shared_ptr<const ExpressionStatement> expr) const = 0;
-		virtual std::any visitFunctionStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Function> expr) const = 0;
-		virtual std::any visitIfStatement(std::shared_ptr<Environment> env, std::shared_ptr<const If> expr) const = 0;
-		virtual std::any visitPrintStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Print> expr) const = 0;
-		virtual std::any visitReturnStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Return> expr) const = 0;
-		virtual std::any visitVarStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Var> expr) const = 0;
-		virtual std::any visitWhileStatement(std::shared_ptr<Environment> env, std::shared_ptr<const While> expr) const = 0;
+		virtual Completion visitBlockStatement(Environment *env, const Block *expr) const = 0;
+		virtual Completion visitClassStatement(Environment *env, const Class *expr) const = 0;
+		virtual Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *expr) const = 0;
+		virtual Completion visitFunctionStatement(Environment *env, const Function *expr) const = 0;
+		virtual Completion visitIfStatement(Environment *env, const If *expr) const = 0;
+		virtual Completion visitPrintStatement(Environment *env, const Print *expr) const = 0;
+		virtual Completion visitReturnStatement(Environment *env, const Return *expr) const = 0;
+		virtual Completion visitVarStatement(Environment *env, const Var *expr) const = 0;
+		virtual Completion visitWhileStatement(Environment *env, const While *expr) const = 0;
 	};
 
 	class Statement
@@ -40,141 +44,150 @@ namespace Lox
 	public:
 		virtual ~Statement(void){};
 		Statement(void){};
-		virtual std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const = 0;
+		virtual Completion accept(Environment *env, const StatementVisitor &visitor) const = 0;
 	};
 
-	class Block : public Statement, public std::enable_shared_from_this<Block>
+	class Block : public Statement
 	{
 	public:
-		std::shared_ptr<std::list<std::shared_ptr<Statement>>> statements;
+		NodeList<const Statement *> statements;
+		mutable int scopeSize{};
+		mutable bool captured{};
 
-		Block(std::shared_ptr<std::list<std::shared_ptr<Statement>>> statements)
+		Block(NodeList<const Statement *> statements)
 			: statements(statements){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitBlockStatement(env, shared_from_this());
+			return visitor.visitBlockStatement(env, this);
 		}
 	};
 
-	class Class : public Statement, public std::enable_shared_from_this<Class>
+	class Class : public Statement
 	{
 	public:
-		std::shared_ptr<const Token> name;
-		std::shared_ptr<const Variable> superclass;
-		std::shared_ptr<std::list<std::shared_ptr<Function>>> methods;
+		const Token *name;
+		const Variable *superclass;
+		NodeList<const Function *> methods;
 
-		Class(std::shared_ptr<const Token> name, std::shared_ptr<const Variable> superclass, std::shared_ptr<std::list<std::shared_ptr<Function>>> methods)
+		Class(const Token *name, const Variable *superclass, NodeList<const Function *> methods)
 			: name(name), superclass(superclass), methods(methods){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitClassStatement(env, shared_from_this());
+			return visitor.visitClassStatement(env, this);
 		}
 	};
 
-	class ExpressionStatement : public Statement, public std::enable_shared_from_this<ExpressionStatement>
+	class ExpressionStatement : public Statement
 	{
 	public:
-		std::shared_ptr<const Expression> expression;
+		const Expression *expression;
 
-		ExpressionStatement(std::shared_ptr<const Expression> expression)
+		ExpressionStatement(const Expression *expression)
 			: expression(expression){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitExpressionStatementStatement(env, shared_from_this());
+			return visitor.visitExpressionStatementStatement(env, this);
 		}
 	};
 
-	class Function : public Statement, public std::enable_shared_from_this<Function>
+	class Function : public Statement
 	{
 	public:
-		std::shared_ptr<const Token> name;
-		std::shared_ptr<std::list<std::shared_ptr<Token>>> params;
-		std::shared_ptr<std::list<std::shared_ptr<Statement>>> body;
-
-		Function(std::shared_ptr<const Token> name, std::shared_ptr<std::list<std::shared_ptr<Token>>> params, std::shared_ptr<std::list<std::shared_ptr<Statement>>> body)
+		const Token *name;
+		NodeList<const Token *> params;
+		NodeList<const Statement *> body;
+		mutable int scopeSize{};
+		mutable bool captured{};
+		mutable std::vector<Capture> upvalues{};
+		mutable int calls{};
+		mutable NativeCode *native{};
+		mutable LazyBody *lazy{};
+
+		Function(const Token *name, NodeList<const Token *> params, NodeList<const Statement *> body)
 			: name(name), params(params), body(body){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitFunctionStatement(env, shared_from_this());
+			return visitor.visitFunctionStatement(env, this);
 		}
 	};
 
-	class If : public Statement, public std::enable_shared_from_this<If>
+	class If : public Statement
 	{
 	public:
-		std::shared_ptr<const Expression> condition;
-		std::shared_ptr<const Statement> thenBranch;
-		std::shared_ptr<const Statement> elseBranch;
+		const Expression *condition;
+		const Statement *thenBranch;
+		const Statement *elseBranch;
 
-		If(std::shared_ptr<const Expression> condition, std::shared_ptr<const Statement> thenBranch, std::shared_ptr<const Statement> elseBranch)
+		If(const Expression *condition, const Statement *thenBranch, const Statement *elseBranch)
 			: condition(condition), thenBranch(thenBranch), elseBranch(elseBranch){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitIfStatement(env, shared_from_this());
+			return visitor.visitIfStatement(env, this);
 		}
 	};
 
-	class Print : public Statement, public std::enable_shared_from_this<Print>
+	class Print : public Statement
 	{
 	public:
-		std::shared_ptr<const Expression> expression;
+		const Expression *expression;
 
-		Print(std::shared_ptr<const Expression> expression)
+		Print(const Expression *expression)
 			: expression(expression){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitPrintStatement(env, shared_from_this());
+			return visitor.visitPrintStatement(env, this);
 		}
 	};
 
-	class Return : public Statement, public std::enable_shared_from_this<Return>
+	class Return : public Statement
 	{
 	public:
-		std::shared_ptr<const Token> keyword;
-		std::shared_ptr<const Expression> value;
+		const Token *keyword;
+		const Expression *value;
+		mutable bool tailCall{};
 
-		Return(std::shared_ptr<const Token> keyword, std::shared_ptr<const Expression> value)
+		Return(const Token *keyword, const Expression *value)
 			: keyword(keyword), value(value){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitReturnStatement(env, shared_from_this());
+			return visitor.visitReturnStatement(env, this);
 		}
 	};
 
-	class Var : public Statement, public std::enable_shared_from_this<Var>
+	class Var : public Statement
 	{
 	public:
-		std::shared_ptr<const Token> name;
-		std::shared_ptr<const Expression> initializer;
+		const Token *name;
+		const Expression *initializer;
 
-		Var(std::shared_ptr<const Token> name, std::shared_ptr<const Expression> initializer)
+		Var(const Token *name, const Expression *initializer)
 			: name(name), initializer(initializer){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitVarStatement(env, shared_from_this());
+			return visitor.visitVarStatement(env, this);
 		}
 	};
 
-	class While : public Statement, public std::enable_shared_from_this<While>
+	class While : public Statement
 	{
 	public:
-		std::shared_ptr<const Expression> condition;
-		std::shared_ptr<const Statement> body;
+		const Expression *condition;
+		const Statement *body;
 
-		While(std::shared_ptr<const Expression> condition, std::shared_ptr<const Statement> body)
+		While(const Expression *condition, const Statement *body)
 			: condition(condition), body(body){};
 
-		std::any accept(std::shared_ptr<Environment> env, const StatementVisitor &visitor) const override
+		Completion accept(Environment *env, const StatementVisitor &visitor) const override
 		{
-			return visitor.visitWhileStatement(env, shared_from_this());
+			return visitor.visitWhileStatement(env, this);
 		}
 	};
 
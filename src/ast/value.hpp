@@ -1,32 +1,55 @@
 #ifndef _VALUE_HPP
 #define _VALUE_HPP
 
-#include <scanner/token.hpp>
-#include <memory>
-#include <utility>
-#include <any>
+#include <ast/object.hpp>
+#include <string>
 
 namespace Lox
 {
     enum class ValueType
     {
-        PRIMITIVE,
-        FUNCTION,
-        IDENTIFIER,
-        STRING,
         NUMBER,
         BOOLEAN,
         NIL,
+        // Object types, keep these last.
+        STRING,
+        PRIMITIVE,
+        FUNCTION,
+        PROTOTYPE,
+        CLOSURE,
     };
 
+    // Doubles, booleans and nil are stored inline, everything else is a
+    // pointer to an Object owned by the Heap.
     class Value
     {
     public:
-        const ValueType type;
-        const std::any value;
+        ValueType type;
+        union
+        {
+            bool boolean;
+            double number;
+            Object *object;
+        } as;
+
+        Value(void) : type(ValueType::NIL) { as.object = nullptr; };
+        explicit Value(double number) : type(ValueType::NUMBER) { as.number = number; };
+        explicit Value(bool boolean) : type(ValueType::BOOLEAN) { as.boolean = boolean; };
+        Value(ValueType type, Object *object) : type(type) { as.object = object; };
 
-        Value(const ValueType type, const std::any value)
-            : type(type), value(value){};
+        bool isObject(void) const
+        {
+            return type >= ValueType::STRING;
+        }
+
+        bool isNumber(void) const { return type == ValueType::NUMBER; };
+        bool isString(void) const { return type == ValueType::STRING; };
+        double asNumber(void) const { return as.number; };
+        bool asBoolean(void) const { return as.boolean; };
+        Object *asObject(void) const { return as.object; };
+        const std::string &asString(void) const { return static_cast<LoxString *>(as.object)->text(); };
     };
+
+    static_assert(sizeof(Value) == 16, "Value should fit in two machine words");
 };
-#endif
\ No newline at end of file
+#endif
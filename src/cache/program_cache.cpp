@@ -0,0 +1,82 @@
+#include <cache/program_cache.hpp>
+#include <cache/program_reader.hpp>
+#include <cache/program_writer.hpp>
+#include <repl/source_file.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Lox;
+using namespace std;
+
+ProgramCache::ProgramCache(void) : enabled(true), directory()
+{
+    const char *home;
+
+    if ((home = getenv("LOX_CACHE_DIR")) != nullptr)
+        directory = home;
+    else if ((home = getenv("XDG_CACHE_HOME")) != nullptr)
+        directory = string(home) + "/cpp_lox";
+    else if ((home = getenv("HOME")) != nullptr)
+        directory = string(home) + "/.cache/cpp_lox";
+}
+
+/* 
+PRIVATE 
+*/
+
+string ProgramCache::path(uint64_t hash) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.loxc", static_cast<unsigned long long>(hash));
+    return directory + name;
+}
+
+/* 
+PUBLIC 
+*/
+
+void ProgramCache::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+}
+
+bool ProgramCache::load(string_view source, Arena &arena, vector<const Statement *> &program) const
+{
+    if (!enabled || directory.empty())
+        return false;
+
+    uint64_t key = programHash(source);
+    // The tokens point into the file, so the arena keeps it mapped.
+    const SourceFile *file = arena.make<SourceFile>(path(key).c_str());
+
+    if (!file->isOpen())
+        return false;
+
+    return ProgramReader(arena, file->text()).read(source, key, program);
+}
+
+void ProgramCache::store(string_view source, const vector<const Statement *> &program) const
+{
+    if (!enabled || directory.empty())
+        return;
+
+    uint64_t key = programHash(source);
+    string file = ProgramWriter().serialize(source, key, program);
+    string target = path(key);
+    string temporary = target + "." + to_string(getpid());
+
+    // Creates the directory and its parent, such as ~/.cache, if missing.
+    mkdir(directory.substr(0, directory.rfind('/')).c_str(), 0755);
+    mkdir(directory.c_str(), 0755);
+
+    // Written aside and renamed, so other runs never map half a file.
+    ofstream out = ofstream(temporary, ios::binary | ios::trunc);
+    out.write(file.data(), file.size());
+    out.close();
+
+    if (!out || rename(temporary.c_str(), target.c_str()) != 0)
+        remove(temporary.c_str());
+}
@@ -0,0 +1,38 @@
+#ifndef _PROGRAM_CACHE_HPP
+#define _PROGRAM_CACHE_HPP
+
+#include <ast/statement.hpp>
+#include <ast/arena.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Lox
+{
+    // Keeps scripts between runs in their optimized and resolved form, in
+    // files named after a hash of the source. A later run of the same source
+    // maps the file and rebuilds the nodes without scanning, parsing or
+    // resolving. Changed sources hash to a different file, and each file
+    // holds a copy of its source to rule out collisions.
+    //
+    // Files go to $LOX_CACHE_DIR, $XDG_CACHE_HOME/cpp_lox or
+    // ~/.cache/cpp_lox, whichever is set first.
+    class ProgramCache
+    {
+    private:
+        bool enabled;
+        std::string directory;
+
+        std::string path(uint64_t hash) const;
+
+    public:
+        ProgramCache(void);
+
+        void setEnabled(bool enabled);
+        bool load(std::string_view source, Arena &arena, std::vector<const Statement *> &program) const;
+        void store(std::string_view source, const std::vector<const Statement *> &program) const;
+    };
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef _PROGRAM_FORMAT_HPP
+#define _PROGRAM_FORMAT_HPP
+
+#include <cstdint>
+#include <string_view>
+
+namespace Lox
+{
+    // Layout of a cached program: a Header, the source it was built from,
+    // a pool of lexemes and string literals, the TokenRecords and then the
+    // nodes in preorder. Files are only read back on the machine that wrote
+    // them, so everything is in native byte order.
+    const uint32_t PROGRAM_FORMAT_VERSION = 5;
+
+    // 64-bit FNV-1a, for keying sources and checking the rest of a file.
+    inline uint64_t programHash(std::string_view bytes)
+    {
+        uint64_t hash = 14695981039346656037ull;
+
+        for (unsigned char c : bytes)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    struct ProgramHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t hash;
+        // Of everything after the source.
+        uint64_t checksum;
+        uint64_t sourceSize;
+        uint64_t poolSize;
+        uint64_t tokenCount;
+        uint64_t nodesSize;
+        uint64_t statementCount;
+    };
+
+    struct TokenRecord
+    {
+        uint32_t type;
+        int32_t line;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // Tags of the nodes in the node stream. NONE stands for a null pointer.
+    enum class NodeTag : uint8_t
+    {
+        NONE,
+        // EXPRESSIONS
+        ASSIGN,
+        BINARY,
+        CALL,
+        GET,
+        GROUPING,
+        LITERAL,
+        LOGICAL,
+        SET,
+        SUPER,
+        THIS,
+        UNARY,
+        VARIABLE,
+        // STATEMENTS
+        BLOCK,
+        CLASS,
+        EXPRESSION_STATEMENT,
+        FUNCTION,
+        IF,
+        PRINT,
+        RETURN,
+        VAR,
+        WHILE
+    };
+}
+
+#endif
@@ -0,0 +1,300 @@
+#include <cache/program_reader.hpp>
+#include <heap/heap.hpp>
+#include <string>
+
+using namespace Lox;
+using namespace std;
+
+ProgramReader::ProgramReader(Arena &arena, string_view file)
+    : arena(arena), cursor(file.data()), end(file.data() + file.size()), pool(), tokens()
+{
+}
+
+/* 
+PRIVATE 
+*/
+
+string_view ProgramReader::bytes(size_t size)
+{
+    if (static_cast<size_t>(end - cursor) < size)
+        throw Malformed();
+
+    string_view view = string_view(cursor, size);
+    cursor += size;
+    return view;
+}
+
+// Every node takes at least a byte, which bounds list sizes in damaged files.
+size_t ProgramReader::count(void)
+{
+    uint32_t count = read<uint32_t>();
+
+    if (count > static_cast<size_t>(end - cursor))
+        throw Malformed();
+
+    return count;
+}
+
+string_view ProgramReader::text(void)
+{
+    uint32_t offset = read<uint32_t>();
+    uint32_t length = read<uint32_t>();
+
+    if (offset > pool.size() || length > pool.size() - offset)
+        throw Malformed();
+
+    return pool.substr(offset, length);
+}
+
+const Token *ProgramReader::token(void)
+{
+    uint32_t index = read<uint32_t>();
+
+    if (index >= tokens.size())
+        throw Malformed();
+
+    return tokens[index];
+}
+
+Slot ProgramReader::slot(void)
+{
+    int depth = read<int32_t>();
+    int index = read<int32_t>();
+    return Slot{depth, index};
+}
+
+const Expression *ProgramReader::expression(void)
+{
+    switch (static_cast<NodeTag>(read<uint8_t>()))
+    {
+    case NodeTag::NONE:
+        return nullptr;
+    case NodeTag::ASSIGN:
+    {
+        const Token *name = token();
+        const Expression *value = expression();
+        const Assign *assign = arena.make<Assign>(name, value);
+        assign->slot = slot();
+        assign->upvalue = read<int32_t>();
+        return assign;
+    }
+    case NodeTag::BINARY:
+    {
+        const Expression *left = expression();
+        const Token *op = token();
+        const Expression *right = expression();
+        return arena.make<Binary>(left, op, right);
+    }
+    case NodeTag::CALL:
+    {
+        const Expression *callee = expression();
+        const Token *paren = token();
+        vector<const Expression *> arguments = vector<const Expression *>(count());
+
+        for (auto &arg : arguments)
+            arg = expression();
+
+        return arena.make<Call>(callee, paren, arena.list(arguments));
+    }
+    case NodeTag::GET:
+    {
+        const Expression *obj = expression();
+        return arena.make<Get>(obj, token());
+    }
+    case NodeTag::GROUPING:
+        return arena.make<Grouping>(expression());
+    case NodeTag::LITERAL:
+    {
+        ValueType type = static_cast<ValueType>(read<uint8_t>());
+
+        switch (type)
+        {
+        case ValueType::STRING:
+            return arena.make<Literal>(Heap::instance().constant(text()));
+        case ValueType::NUMBER:
+            return arena.make<Literal>(Value(read<double>()));
+        case ValueType::BOOLEAN:
+            return arena.make<Literal>(Value(read<uint8_t>() != 0));
+        default:
+            return arena.make<Literal>(Value());
+        }
+    }
+    case NodeTag::LOGICAL:
+    {
+        const Expression *left = expression();
+        const Token *op = token();
+        const Expression *right = expression();
+        return arena.make<Logical>(left, op, right);
+    }
+    case NodeTag::SET:
+    {
+        const Expression *obj = expression();
+        const Token *name = token();
+        const Expression *value = expression();
+        return arena.make<Set>(obj, name, value);
+    }
+    case NodeTag::SUPER:
+    {
+        const Token *keyword = token();
+        return arena.make<Super>(keyword, token());
+    }
+    case NodeTag::THIS:
+        return arena.make<This>(token());
+    case NodeTag::UNARY:
+    {
+        const Token *op = token();
+        return arena.make<Unary>(op, expression());
+    }
+    case NodeTag::VARIABLE:
+    {
+        const Variable *variable = arena.make<Variable>(token());
+        variable->slot = slot();
+        variable->upvalue = read<int32_t>();
+        return variable;
+    }
+    default:
+        throw Malformed();
+    }
+}
+
+const Statement *ProgramReader::statement(void)
+{
+    switch (static_cast<NodeTag>(read<uint8_t>()))
+    {
+    case NodeTag::NONE:
+        return nullptr;
+    case NodeTag::BLOCK:
+    {
+        const Block *block = arena.make<Block>(statements());
+        block->scopeSize = read<int32_t>();
+        block->captured = read<uint8_t>() != 0;
+        return block;
+    }
+    case NodeTag::CLASS:
+    {
+        const Token *name = token();
+        const Expression *superclass = expression();
+        vector<const Function *> methods = vector<const Function *>(count());
+
+        if (superclass != nullptr && dynamic_cast<const Variable *>(superclass) == nullptr)
+            throw Malformed();
+
+        for (auto &method : methods)
+            if ((method = dynamic_cast<const Function *>(statement())) == nullptr)
+                throw Malformed();
+
+        return arena.make<Class>(name, static_cast<const Variable *>(superclass), arena.list(methods));
+    }
+    case NodeTag::EXPRESSION_STATEMENT:
+        return arena.make<ExpressionStatement>(expression());
+    case NodeTag::FUNCTION:
+    {
+        const Token *name = token();
+        vector<const Token *> params = vector<const Token *>(count());
+
+        for (auto &param : params)
+            param = token();
+
+        NodeList<const Statement *> body = statements();
+        const Function *function = arena.make<Function>(name, arena.list(params), body);
+        function->scopeSize = read<int32_t>();
+        function->captured = read<uint8_t>() != 0;
+        function->upvalues = vector<Capture>(count());
+
+        for (Capture &capture : function->upvalues)
+        {
+            capture.slot = slot();
+            capture.upvalue = read<int32_t>();
+        }
+
+        return function;
+    }
+    case NodeTag::IF:
+    {
+        const Expression *condition = expression();
+        const Statement *thenBranch = statement();
+        const Statement *elseBranch = statement();
+        return arena.make<If>(condition, thenBranch, elseBranch);
+    }
+    case NodeTag::PRINT:
+        return arena.make<Print>(expression());
+    case NodeTag::RETURN:
+    {
+        const Token *keyword = token();
+        const Return *result = arena.make<Return>(keyword, expression());
+        result->tailCall = read<uint8_t>() != 0;
+        return result;
+    }
+    case NodeTag::VAR:
+    {
+        const Token *name = token();
+        return arena.make<Var>(name, expression());
+    }
+    case NodeTag::WHILE:
+    {
+        const Expression *condition = expression();
+        return arena.make<While>(condition, statement());
+    }
+    default:
+        throw Malformed();
+    }
+}
+
+NodeList<const Statement *> ProgramReader::statements(void)
+{
+    vector<const Statement *> list = vector<const Statement *>(count());
+
+    for (auto &stmt : list)
+        stmt = statement();
+
+    return arena.list(list);
+}
+
+/* 
+PUBLIC 
+*/
+
+bool ProgramReader::read(string_view source, uint64_t hash, vector<const Statement *> &program)
+{
+    try
+    {
+        ProgramHeader header = read<ProgramHeader>();
+
+        if (memcmp(header.magic, "LOXC", sizeof(header.magic)) != 0 ||
+            header.version != PROGRAM_FORMAT_VERSION ||
+            header.hash != hash ||
+            header.sourceSize != source.size() ||
+            bytes(header.sourceSize) != source ||
+            programHash(string_view(cursor, end - cursor)) != header.checksum)
+            return false;
+
+        pool = bytes(header.poolSize);
+
+        for (uint64_t i = 0; i < header.tokenCount; i++)
+        {
+            TokenRecord record = read<TokenRecord>();
+
+            if (record.type > static_cast<uint32_t>(TokenType::ENDOF) ||
+                record.offset > pool.size() || record.length > pool.size() - record.offset)
+                return false;
+
+            tokens.push_back(arena.make<Token>(static_cast<TokenType>(record.type),
+                                               pool.substr(record.offset, record.length),
+                                               record.line));
+        }
+
+        if (header.nodesSize != static_cast<size_t>(end - cursor))
+            return false;
+
+        program.clear();
+
+        for (uint64_t i = 0; i < header.statementCount; i++)
+            program.push_back(statement());
+
+        return cursor == end;
+    }
+    catch (Malformed &)
+    {
+        return false;
+    }
+}
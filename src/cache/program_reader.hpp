@@ -0,0 +1,62 @@
+#ifndef _PROGRAM_READER_HPP
+#define _PROGRAM_READER_HPP
+
+#include <ast/expression.hpp>
+#include <ast/statement.hpp>
+#include <ast/arena.hpp>
+#include <cache/program_format.hpp>
+#include <scanner/token.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace Lox
+{
+    // Rebuilds the nodes of a cached program in an arena. Lexemes stay views
+    // into the file, so it must live as long as the arena. Files that don't
+    // hold exactly the given source, or are damaged, are rejected.
+    class ProgramReader
+    {
+    private:
+        // Thrown from anywhere in a read that runs past the file.
+        struct Malformed
+        {
+        };
+
+        Arena &arena;
+        const char *cursor;
+        const char *end;
+        std::string_view pool;
+        std::vector<const Token *> tokens;
+
+        template <typename T>
+        T read(void)
+        {
+            T value;
+
+            if (static_cast<size_t>(end - cursor) < sizeof(T))
+                throw Malformed();
+
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return value;
+        }
+
+        std::string_view bytes(size_t size);
+        size_t count(void);
+        std::string_view text(void);
+        const Token *token(void);
+        Slot slot(void);
+        const Expression *expression(void);
+        const Statement *statement(void);
+        NodeList<const Statement *> statements(void);
+
+    public:
+        ProgramReader(Arena &arena, std::string_view file);
+
+        bool read(std::string_view source, uint64_t hash, std::vector<const Statement *> &program);
+    };
+}
+
+#endif
@@ -0,0 +1,335 @@
+#include <cache/program_writer.hpp>
+
+using namespace Lox;
+using namespace std;
+
+ProgramWriter::ProgramWriter(void)
+{
+}
+
+/* 
+PRIVATE 
+*/
+
+void ProgramWriter::tag(NodeTag tag) const
+{
+    write(static_cast<uint8_t>(tag));
+}
+
+uint32_t ProgramWriter::intern(string_view text) const
+{
+    auto search = poolOffsets.find(text);
+
+    if (search != poolOffsets.end())
+        return search->second;
+
+    uint32_t offset = pool.size();
+    pool.append(text);
+    // Keyed by a view of the input, which outlives the writer.
+    poolOffsets[text] = offset;
+    return offset;
+}
+
+void ProgramWriter::text(string_view text) const
+{
+    write(intern(text));
+    write(static_cast<uint32_t>(text.size()));
+}
+
+void ProgramWriter::token(const Token *token) const
+{
+    auto search = tokenIndices.find(token);
+
+    if (search != tokenIndices.end())
+    {
+        write(search->second);
+        return;
+    }
+
+    uint32_t index = tokens.size();
+    tokens.push_back(TokenRecord{static_cast<uint32_t>(token->type), token->line,
+                                 intern(token->lexeme), static_cast<uint32_t>(token->lexeme.size())});
+    tokenIndices[token] = index;
+
+    write(index);
+}
+
+void ProgramWriter::slot(const Slot &slot) const
+{
+    write(static_cast<int32_t>(slot.depth));
+    write(static_cast<int32_t>(slot.index));
+}
+
+void ProgramWriter::write(const Expression *expr) const
+{
+    if (expr == nullptr)
+        tag(NodeTag::NONE);
+    else
+        expr->accept(nullptr, *this);
+}
+
+void ProgramWriter::write(const Statement *stmt) const
+{
+    if (stmt == nullptr)
+        tag(NodeTag::NONE);
+    else
+        stmt->accept(nullptr, *this);
+}
+
+void ProgramWriter::write(NodeList<const Statement *> statements) const
+{
+    write(static_cast<uint32_t>(statements.size()));
+
+    for (auto stmt : statements)
+        write(stmt);
+}
+
+/* 
+EXPRESSIONS 
+*/
+
+Value ProgramWriter::visitAssignExpression(Environment *, const Assign *expr) const
+{
+    tag(NodeTag::ASSIGN);
+    token(expr->name);
+    write(expr->value);
+    slot(expr->slot);
+    write(static_cast<int32_t>(expr->upvalue));
+    return Value();
+}
+
+Value ProgramWriter::visitBinaryExpression(Environment *, const Binary *expr) const
+{
+    tag(NodeTag::BINARY);
+    write(expr->left);
+    token(expr->op);
+    write(expr->right);
+    return Value();
+}
+
+Value ProgramWriter::visitCallExpression(Environment *, const Call *expr) const
+{
+    tag(NodeTag::CALL);
+    write(expr->callee);
+    token(expr->paren);
+    write(static_cast<uint32_t>(expr->arguments.size()));
+
+    for (auto arg : expr->arguments)
+        write(arg);
+
+    return Value();
+}
+
+Value ProgramWriter::visitGetExpression(Environment *, const Get *expr) const
+{
+    tag(NodeTag::GET);
+    write(expr->obj);
+    token(expr->name);
+    return Value();
+}
+
+Value ProgramWriter::visitGroupingExpression(Environment *, const Grouping *expr) const
+{
+    tag(NodeTag::GROUPING);
+    write(expr->expression);
+    return Value();
+}
+
+Value ProgramWriter::visitLiteralExpression(Environment *, const Literal *expr) const
+{
+    tag(NodeTag::LITERAL);
+    write(static_cast<uint8_t>(expr->value.type));
+
+    switch (expr->value.type)
+    {
+    case ValueType::STRING:
+        text(expr->value.asString());
+        break;
+    case ValueType::NUMBER:
+        write(expr->value.asNumber());
+        break;
+    case ValueType::BOOLEAN:
+        write(static_cast<uint8_t>(expr->value.asBoolean()));
+        break;
+    default:
+        break;
+    }
+
+    return Value();
+}
+
+Value ProgramWriter::visitLogicalExpression(Environment *, const Logical *expr) const
+{
+    tag(NodeTag::LOGICAL);
+    write(expr->left);
+    token(expr->op);
+    write(expr->right);
+    return Value();
+}
+
+Value ProgramWriter::visitSetExpression(Environment *, const Set *expr) const
+{
+    tag(NodeTag::SET);
+    write(expr->obj);
+    token(expr->name);
+    write(expr->value);
+    return Value();
+}
+
+Value ProgramWriter::visitSuperExpression(Environment *, const Super *expr) const
+{
+    tag(NodeTag::SUPER);
+    token(expr->keyword);
+    token(expr->method);
+    return Value();
+}
+
+Value ProgramWriter::visitThisExpression(Environment *, const This *expr) const
+{
+    tag(NodeTag::THIS);
+    token(expr->keyword);
+    return Value();
+}
+
+Value ProgramWriter::visitUnaryExpression(Environment *, const Unary *expr) const
+{
+    tag(NodeTag::UNARY);
+    token(expr->op);
+    write(expr->right);
+    return Value();
+}
+
+Value ProgramWriter::visitVariableExpression(Environment *, const Variable *expr) const
+{
+    tag(NodeTag::VARIABLE);
+    token(expr->name);
+    slot(expr->slot);
+    write(static_cast<int32_t>(expr->upvalue));
+    return Value();
+}
+
+/* 
+STATEMENTS 
+*/
+
+Completion ProgramWriter::visitBlockStatement(Environment *, const Block *stmt) const
+{
+    tag(NodeTag::BLOCK);
+    write(stmt->statements);
+    write(static_cast<int32_t>(stmt->scopeSize));
+    write(static_cast<uint8_t>(stmt->captured));
+    return Completion();
+}
+
+Completion ProgramWriter::visitClassStatement(Environment *, const Class *stmt) const
+{
+    tag(NodeTag::CLASS);
+    token(stmt->name);
+    write(stmt->superclass);
+    write(static_cast<uint32_t>(stmt->methods.size()));
+
+    for (auto method : stmt->methods)
+        write(method);
+
+    return Completion();
+}
+
+Completion ProgramWriter::visitExpressionStatementStatement(Environment *, const ExpressionStatement *stmt) const
+{
+    tag(NodeTag::EXPRESSION_STATEMENT);
+    write(stmt->expression);
+    return Completion();
+}
+
+Completion ProgramWriter::visitFunctionStatement(Environment *, const Function *stmt) const
+{
+    tag(NodeTag::FUNCTION);
+    token(stmt->name);
+    write(static_cast<uint32_t>(stmt->params.size()));
+
+    for (auto param : stmt->params)
+        token(param);
+
+    write(stmt->body);
+    write(static_cast<int32_t>(stmt->scopeSize));
+    write(static_cast<uint8_t>(stmt->captured));
+    write(static_cast<uint32_t>(stmt->upvalues.size()));
+
+    for (const Capture &capture : stmt->upvalues)
+    {
+        slot(capture.slot);
+        write(static_cast<int32_t>(capture.upvalue));
+    }
+
+    return Completion();
+}
+
+Completion ProgramWriter::visitIfStatement(Environment *, const If *stmt) const
+{
+    tag(NodeTag::IF);
+    write(stmt->condition);
+    write(stmt->thenBranch);
+    write(stmt->elseBranch);
+    return Completion();
+}
+
+Completion ProgramWriter::visitPrintStatement(Environment *, const Print *stmt) const
+{
+    tag(NodeTag::PRINT);
+    write(stmt->expression);
+    return Completion();
+}
+
+Completion ProgramWriter::visitReturnStatement(Environment *, const Return *stmt) const
+{
+    tag(NodeTag::RETURN);
+    token(stmt->keyword);
+    write(stmt->value);
+    write(static_cast<uint8_t>(stmt->tailCall));
+    return Completion();
+}
+
+Completion ProgramWriter::visitVarStatement(Environment *, const Var *stmt) const
+{
+    tag(NodeTag::VAR);
+    token(stmt->name);
+    write(stmt->initializer);
+    return Completion();
+}
+
+Completion ProgramWriter::visitWhileStatement(Environment *, const While *stmt) const
+{
+    tag(NodeTag::WHILE);
+    write(stmt->condition);
+    write(stmt->body);
+    return Completion();
+}
+
+/* 
+OTHER 
+*/
+
+string ProgramWriter::serialize(string_view source, uint64_t hash,
+                                const vector<const Statement *> &statements) const
+{
+    for (auto stmt : statements)
+        write(stmt);
+
+    string body;
+
+    body.append(pool);
+    body.append(reinterpret_cast<const char *>(tokens.data()), tokens.size() * sizeof(TokenRecord));
+    body.append(reinterpret_cast<const char *>(nodes.data()), nodes.size());
+
+    ProgramHeader header = ProgramHeader{{'L', 'O', 'X', 'C'}, PROGRAM_FORMAT_VERSION, hash,
+                                         programHash(body), source.size(), pool.size(),
+                                         tokens.size(), nodes.size(), statements.size()};
+    string file;
+
+    file.reserve(sizeof(header) + source.size() + body.size());
+    file.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.append(source);
+    file.append(body);
+
+    return file;
+}
@@ -0,0 +1,81 @@
+#ifndef _PROGRAM_WRITER_HPP
+#define _PROGRAM_WRITER_HPP
+
+#include <ast/expression.hpp>
+#include <ast/statement.hpp>
+#include <cache/program_format.hpp>
+#include <environment/environment.hpp>
+#include <scanner/token.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Lox
+{
+    // Flattens a resolved program into the cache format. Resolver results
+    // (slots and scope sizes) are kept, while the quickening and JIT state
+    // is left for the next run to gather again.
+    class ProgramWriter : public ExpressionVisitor,
+                          public StatementVisitor
+    {
+    private:
+        mutable std::vector<uint8_t> nodes;
+        mutable std::string pool;
+        mutable std::unordered_map<std::string_view, uint32_t> poolOffsets;
+        mutable std::vector<TokenRecord> tokens;
+        mutable std::unordered_map<const Token *, uint32_t> tokenIndices;
+
+        template <typename T>
+        void write(const T &value) const
+        {
+            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+            nodes.insert(nodes.end(), bytes, bytes + sizeof(T));
+        }
+
+        void tag(NodeTag tag) const;
+        uint32_t intern(std::string_view text) const;
+        void text(std::string_view text) const;
+        void token(const Token *token) const;
+        void slot(const Slot &slot) const;
+        void write(const Expression *expr) const;
+        void write(const Statement *stmt) const;
+        void write(NodeList<const Statement *> statements) const;
+
+    public:
+        ProgramWriter(void);
+
+        // EXPRESSIONS
+        Value visitAssignExpression(Environment *env, const Assign *expr) const override;
+        Value visitBinaryExpression(Environment *env, const Binary *expr) const override;
+        Value visitCallExpression(Environment *env, const Call *expr) const override;
+        Value visitGetExpression(Environment *env, const Get *expr) const override;
+        Value visitGroupingExpression(Environment *env, const Grouping *expr) const override;
+        Value visitLiteralExpression(Environment *env, const Literal *expr) const override;
+        Value visitLogicalExpression(Environment *env, const Logical *expr) const override;
+        Value visitSetExpression(Environment *env, const Set *expr) const override;
+        Value visitSuperExpression(Environment *env, const Super *expr) const override;
+        Value visitThisExpression(Environment *env, const This *expr) const override;
+        Value visitUnaryExpression(Environment *env, const Unary *expr) const override;
+        Value visitVariableExpression(Environment *env, const Variable *expr) const override;
+
+        // STATEMENTS
+        Completion visitBlockStatement(Environment *env, const Block *stmt) const override;
+        Completion visitClassStatement(Environment *env, const Class *stmt) const override;
+        Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const override;
+        Completion visitFunctionStatement(Environment *env, const Function *stmt) const override;
+        Completion visitIfStatement(Environment *env, const If *stmt) const override;
+        Completion visitPrintStatement(Environment *env, const Print *stmt) const override;
+        Completion visitReturnStatement(Environment *env, const Return *stmt) const override;
+        Completion visitVarStatement(Environment *env, const Var *stmt) const override;
+        Completion visitWhileStatement(Environment *env, const While *stmt) const override;
+
+        // OTHER
+        // The whole file for a program built from source.
+        std::string serialize(std::string_view source, uint64_t hash,
+                              const std::vector<const Statement *> &statements) const;
+    };
+}
+
+#endif
@@ -0,0 +1,843 @@
+#include <closures/closure_compiler.hpp>
+#include <ast/primitive.hpp>
+#include <repl/repl.hpp>
+
+using namespace Lox;
+using namespace std;
+
+Value LoxCompiledFunction::call(const Interpreter &, Arguments args)
+{
+    return engine.invoke(*this, args);
+}
+
+ClosureCompiler::ClosureCompiler(void)
+    : frames(),
+      scopes(),
+      code(),
+      stack(),
+      arguments(),
+      expression(),
+      statement(),
+      globals(Heap::instance().allocate<Environment>())
+{
+    Heap::instance().addRoots(this);
+    globals->define("clock", Value(ValueType::PRIMITIVE, Heap::instance().allocate<LoxPrimitive>(LoxPrimitiveFn::clock)));
+}
+
+ClosureCompiler::~ClosureCompiler(void)
+{
+    Heap::instance().removeRoots(this);
+}
+
+void ClosureCompiler::setMaxDepth(size_t depth)
+{
+    calls.setLimit(depth);
+    arguments.reserve(depth);
+}
+
+/*
+PRIVATE
+*/
+
+CompiledExpression ClosureCompiler::compile(const Expression *expr) const
+{
+    expr->accept(nullptr, *this);
+    return expression;
+}
+
+CompiledStatement ClosureCompiler::compile(const Statement *stmt) const
+{
+    stmt->accept(nullptr, *this);
+    return statement;
+}
+
+#define NUMBER_TEST(op)                                                  \
+    [left, right, token](Environment *env)                               \
+    {                                                                    \
+        Value l = left(env);                                             \
+        Value r = right(env);                                            \
+        if (!l.isNumber() || !r.isNumber())                              \
+            throw RuntimeError(*token, "Operands must be numbers.");     \
+        return l.asNumber() op r.asNumber();                             \
+    }
+
+#define NUMBER_CONSTANT_TEST(op)                                         \
+    [left, constant, token](Environment *env)                            \
+    {                                                                    \
+        Value l = left(env);                                             \
+        if (!l.isNumber())                                               \
+            throw RuntimeError(*token, "Operands must be numbers.");     \
+        return l.asNumber() op constant;                                 \
+    }
+
+static bool isComparison(TokenType type)
+{
+    return type == TokenType::GREATER || type == TokenType::GREATER_EQUAL ||
+           type == TokenType::LESS || type == TokenType::LESS_EQUAL;
+}
+
+// Comparisons decide branches without making a Value first.
+CompiledCondition ClosureCompiler::compileCondition(const Expression *expr) const
+{
+    auto binary = dynamic_cast<const Binary *>(expr);
+
+    if (binary != nullptr && isComparison(binary->op->type))
+    {
+        CompiledExpression left = compile(binary->left);
+        const Token *token = binary->op;
+        auto literal = dynamic_cast<const Literal *>(binary->right);
+
+        if (literal != nullptr && literal->value.isNumber())
+        {
+            double constant = literal->value.asNumber();
+
+            switch (token->type)
+            {
+            case TokenType::GREATER:
+                return CompiledCondition(code, NUMBER_CONSTANT_TEST(>));
+            case TokenType::GREATER_EQUAL:
+                return CompiledCondition(code, NUMBER_CONSTANT_TEST(>=));
+            case TokenType::LESS:
+                return CompiledCondition(code, NUMBER_CONSTANT_TEST(<));
+            default:
+                return CompiledCondition(code, NUMBER_CONSTANT_TEST(<=));
+            }
+        }
+
+        CompiledExpression right = compile(binary->right);
+
+        switch (token->type)
+        {
+        case TokenType::GREATER:
+            return CompiledCondition(code, NUMBER_TEST(>));
+        case TokenType::GREATER_EQUAL:
+            return CompiledCondition(code, NUMBER_TEST(>=));
+        case TokenType::LESS:
+            return CompiledCondition(code, NUMBER_TEST(<));
+        default:
+            return CompiledCondition(code, NUMBER_TEST(<=));
+        }
+    }
+
+    CompiledExpression value = compile(expr);
+
+    return CompiledCondition(code, [value](Environment *env)
+                             { return Interpreter::isTruthy(value(env)); });
+}
+
+#undef NUMBER_TEST
+#undef NUMBER_CONSTANT_TEST
+
+CompiledStatement ClosureCompiler::compileBody(NodeList<const Statement *> statements) const
+{
+    vector<CompiledStatement> compiled;
+
+    for (auto stmt : statements)
+        compiled.push_back(compile(stmt));
+
+    NodeList<CompiledStatement> body = code.list(compiled);
+
+    return CompiledStatement(code, [body](Environment *env)
+                             {
+                                 for (const CompiledStatement &statement : body)
+                                 {
+                                     Completion completion = statement(env);
+
+                                     if (completion.isReturn())
+                                         return completion;
+                                 }
+
+                                 return Completion(); });
+}
+
+// The resolver counts every scope, but only some of them have an
+// Environment at runtime.
+Slot ClosureCompiler::locate(const Slot &slot) const
+{
+    int depth = 0;
+
+    for (int i = 0; i < slot.depth; i++)
+        if (scopes[scopes.size() - 1 - i])
+            depth++;
+
+    return Slot{depth, slot.index};
+}
+
+Value ClosureCompiler::call(const Token *paren, const Value &callee, Arguments args) const
+{
+    if (callee.type == ValueType::FUNCTION || callee.type == ValueType::PRIMITIVE)
+    {
+        auto function = static_cast<LoxCallable *>(callee.asObject());
+
+        if (args.size() != function->arity())
+            throw RuntimeError(*paren,
+                               "Expected " + to_string(function->arity()) +
+                                   " arguments but got " + to_string(args.size()) +
+                                   ".");
+    }
+
+    if (callee.type == ValueType::FUNCTION)
+    {
+        CallDepth::Guard guard = CallDepth::Guard(calls, *paren);
+        return invoke(*static_cast<LoxCompiledFunction *>(callee.asObject()), args);
+    }
+
+    if (callee.type == ValueType::PRIMITIVE)
+        return static_cast<LoxPrimitive *>(callee.asObject())->invoke(args);
+
+    throw RuntimeError(*paren, "Can only call functions and classes.");
+}
+
+// The arguments are evaluated in place on the argument stack, and only
+// popped if the call isn't left to invoke().
+CompiledStatement ClosureCompiler::compileTailCall(const Call *expr) const
+{
+    CompiledExpression callee = compile(expr->callee);
+    vector<CompiledExpression> compiled;
+    const Token *paren = expr->paren;
+
+    for (auto arg : expr->arguments)
+        compiled.push_back(compile(arg));
+
+    NodeList<CompiledExpression> args = code.list(compiled);
+
+    return CompiledStatement(code, [this, callee, args, paren](Environment *env)
+                             {
+                                 ArgumentStack::Scope scope = ArgumentStack::Scope(arguments);
+                                 Value function = callee(env);
+
+                                 arguments.push(*paren, function);
+
+                                 for (const CompiledExpression &arg : args)
+                                 {
+                                     Value value = arg(env);
+                                     arguments.push(*paren, value);
+                                 }
+
+                                 if (Interpreter::isTailCallable(function, args.size()))
+                                 {
+                                     scope.keep();
+                                     return Completion(CompletionType::TAIL_CALL, function);
+                                 }
+
+                                 return Completion(call(paren, function, scope.arguments())); });
+}
+
+Completion ClosureCompiler::run(const LoxCompiledFunction &function, Arguments args) const
+{
+    Frame frame = Frame(stack, nullptr, function.declaration->scopeSize);
+    frame.environment->setUpvalues(function.upvalues.data());
+
+    for (auto &arg : args)
+        frame.environment->define(arg);
+
+    frames.push_back(frame.environment);
+    Completion completion = function.body(frame.environment);
+    frames.pop_back();
+
+    return completion;
+}
+
+/*
+PUBLIC
+*/
+
+// Tail calls come back here with their callee and arguments on the argument
+// stack, and run in this loop instead of a nested call, as in LoxFunction.
+Value ClosureCompiler::invoke(const LoxCompiledFunction &function, Arguments args) const
+{
+    ArgumentStack::Scope scope = ArgumentStack::Scope(arguments);
+    const LoxCompiledFunction *current = &function;
+
+    for (;;)
+    {
+        size_t mark = arguments.size();
+        Completion completion = run(*current, args);
+
+        if (!completion.isTailCall())
+            return completion.value;
+
+        current = static_cast<LoxCompiledFunction *>(completion.value.asObject());
+        args = scope.replace(mark);
+    }
+}
+
+/*
+EXPRESSIONS
+*/
+
+#define NUMBER_OP(op)                                                    \
+    [left, right, token](Environment *env)                               \
+    {                                                                    \
+        Value l = left(env);                                             \
+        Value r = right(env);                                            \
+        if (!l.isNumber() || !r.isNumber())                              \
+            throw RuntimeError(*token, "Operands must be numbers.");     \
+        return Value(l.asNumber() op r.asNumber());                      \
+    }
+
+#define NUMBER_CONSTANT_OP(op)                                           \
+    [left, constant, token](Environment *env)                            \
+    {                                                                    \
+        Value l = left(env);                                             \
+        if (!l.isNumber())                                               \
+            throw RuntimeError(*token, "Operands must be numbers.");     \
+        return Value(l.asNumber() op constant);                          \
+    }
+
+Value ClosureCompiler::visitAssignExpression(Environment *, const Assign *expr) const
+{
+    CompiledExpression value = compile(expr->value);
+
+    if (expr->upvalue >= 0)
+    {
+        int upvalue = expr->upvalue;
+
+        expression = CompiledExpression(code, [value, upvalue](Environment *env)
+                                        {
+                                            Value result = value(env);
+                                            env->assignUpvalue(upvalue, result);
+                                            return result; });
+    }
+    else if (expr->slot.isGlobal())
+    {
+        const Token *name = expr->name;
+        Value **global = code.make<Value *>(nullptr);
+
+        expression = CompiledExpression(code, [this, value, name, global](Environment *env)
+                                        {
+                                            Value result = value(env);
+
+                                            if (*global == nullptr)
+                                                *global = globals->find(*name);
+
+                                            if (*global == nullptr)
+                                                globals->assign(*name, result);
+                                            else
+                                                **global = result;
+
+                                            return result; });
+    }
+    else
+    {
+        Slot slot = locate(expr->slot);
+
+        expression = CompiledExpression(code, [value, slot](Environment *env)
+                                        {
+                                            Value result = value(env);
+                                            env->assignAt(slot, result);
+                                            return result; });
+    }
+
+    return Value();
+}
+
+Value ClosureCompiler::visitBinaryExpression(Environment *, const Binary *expr) const
+{
+    CompiledExpression left = compile(expr->left);
+    const Token *token = expr->op;
+    auto literal = dynamic_cast<const Literal *>(expr->right);
+
+    // Arithmetic on a constant skips running the constant's node.
+    if (literal != nullptr && literal->value.isNumber())
+    {
+        double constant = literal->value.asNumber();
+
+        switch (token->type)
+        {
+        case TokenType::GREATER:
+            expression = CompiledExpression(code, NUMBER_CONSTANT_OP(>));
+            return Value();
+        case TokenType::GREATER_EQUAL:
+            expression = CompiledExpression(code, NUMBER_CONSTANT_OP(>=));
+            return Value();
+        case TokenType::LESS:
+            expression = CompiledExpression(code, NUMBER_CONSTANT_OP(<));
+            return Value();
+        case TokenType::LESS_EQUAL:
+            expression = CompiledExpression(code, NUMBER_CONSTANT_OP(<=));
+            return Value();
+        case TokenType::MINUS:
+            expression = CompiledExpression(code, NUMBER_CONSTANT_OP(-));
+            return Value();
+        case TokenType::SLASH:
+            expression = CompiledExpression(code, NUMBER_CONSTANT_OP(/));
+            return Value();
+        case TokenType::STAR:
+            expression = CompiledExpression(code, NUMBER_CONSTANT_OP(*));
+            return Value();
+        default:
+            break;
+        }
+    }
+
+    CompiledExpression right = compile(expr->right);
+
+    // Only a left operand that isn't a number needs rooting while the right
+    // one runs.
+    switch (token->type)
+    {
+    case TokenType::GREATER:
+        expression = CompiledExpression(code, NUMBER_OP(>));
+        break;
+    case TokenType::GREATER_EQUAL:
+        expression = CompiledExpression(code, NUMBER_OP(>=));
+        break;
+    case TokenType::LESS:
+        expression = CompiledExpression(code, NUMBER_OP(<));
+        break;
+    case TokenType::LESS_EQUAL:
+        expression = CompiledExpression(code, NUMBER_OP(<=));
+        break;
+    case TokenType::MINUS:
+        expression = CompiledExpression(code, NUMBER_OP(-));
+        break;
+    case TokenType::SLASH:
+        expression = CompiledExpression(code, NUMBER_OP(/));
+        break;
+    case TokenType::STAR:
+        expression = CompiledExpression(code, NUMBER_OP(*));
+        break;
+    case TokenType::BANG_EQUAL:
+        expression = CompiledExpression(code, [left, right](Environment *env)
+                                        {
+                                            Value l = left(env);
+
+                                            if (l.isNumber())
+                                                return Value(!Interpreter::isEqual(l, right(env)));
+
+                                            Heap::Scope scope;
+                                            Heap::instance().push(l);
+                                            return Value(!Interpreter::isEqual(l, right(env))); });
+        break;
+    case TokenType::EQUAL_EQUAL:
+        expression = CompiledExpression(code, [left, right](Environment *env)
+                                        {
+                                            Value l = left(env);
+
+                                            if (l.isNumber())
+                                                return Value(Interpreter::isEqual(l, right(env)));
+
+                                            Heap::Scope scope;
+                                            Heap::instance().push(l);
+                                            return Value(Interpreter::isEqual(l, right(env))); });
+        break;
+    case TokenType::PLUS:
+        expression = CompiledExpression(code, [left, right, token](Environment *env)
+                                        {
+                                            Value l = left(env);
+
+                                            if (l.isNumber())
+                                            {
+                                                Value r = right(env);
+
+                                                if (r.isNumber())
+                                                    return Value(l.asNumber() + r.asNumber());
+
+                                                throw RuntimeError(*token, "Operands must be two numbers or two strings.");
+                                            }
+
+                                            Heap::Scope scope;
+                                            Heap::instance().push(l);
+                                            Value r = right(env);
+
+                                            if (l.isString() && r.isString())
+                                                return Heap::instance().concat(l, r);
+
+                                            throw RuntimeError(*token, "Operands must be two numbers or two strings."); });
+        break;
+    default:
+        expression = CompiledExpression(code, [left, right](Environment *env)
+                                        {
+                                            left(env);
+                                            right(env);
+                                            return Value(); });
+    }
+
+    return Value();
+}
+
+Value ClosureCompiler::visitCallExpression(Environment *, const Call *expr) const
+{
+    CompiledExpression callee = compile(expr->callee);
+    vector<CompiledExpression> compiled;
+    const Token *paren = expr->paren;
+
+    for (auto arg : expr->arguments)
+        compiled.push_back(compile(arg));
+
+    NodeList<CompiledExpression> args = code.list(compiled);
+
+    expression = CompiledExpression(code, [this, callee, args, paren](Environment *env)
+                                    {
+                                        ArgumentStack::Scope scope = ArgumentStack::Scope(arguments);
+                                        Value function = callee(env);
+
+                                        arguments.push(*paren, function);
+
+                                        for (const CompiledExpression &arg : args)
+                                        {
+                                            Value value = arg(env);
+                                            arguments.push(*paren, value);
+                                        }
+
+                                        return call(paren, function, scope.arguments()); });
+
+    return Value();
+}
+
+Value ClosureCompiler::visitGetExpression(Environment *, const Get *) const
+{
+    expression = CompiledExpression(code, [](Environment *)
+                                    { return Value(); });
+    return Value();
+}
+
+Value ClosureCompiler::visitGroupingExpression(Environment *, const Grouping *expr) const
+{
+    expression = compile(expr->expression);
+    return Value();
+}
+
+Value ClosureCompiler::visitLiteralExpression(Environment *, const Literal *expr) const
+{
+    Value value = expr->value;
+
+    expression = CompiledExpression(code, [value](Environment *)
+                                    { return value; });
+    return Value();
+}
+
+Value ClosureCompiler::visitLogicalExpression(Environment *, const Logical *expr) const
+{
+    CompiledExpression left = compile(expr->left);
+    CompiledExpression right = compile(expr->right);
+
+    if (expr->op->type == TokenType::OR)
+    {
+        expression = CompiledExpression(code, [left, right](Environment *env)
+                                        {
+                                            Value l = left(env);
+                                            return Interpreter::isTruthy(l) ? l : right(env); });
+    }
+    else
+    {
+        expression = CompiledExpression(code, [left, right](Environment *env)
+                                        {
+                                            Value l = left(env);
+                                            return !Interpreter::isTruthy(l) ? l : right(env); });
+    }
+
+    return Value();
+}
+
+Value ClosureCompiler::visitSetExpression(Environment *, const Set *) const
+{
+    expression = CompiledExpression(code, [](Environment *)
+                                    { return Value(); });
+    return Value();
+}
+
+Value ClosureCompiler::visitSuperExpression(Environment *, const Super *) const
+{
+    expression = CompiledExpression(code, [](Environment *)
+                                    { return Value(); });
+    return Value();
+}
+
+Value ClosureCompiler::visitThisExpression(Environment *, const This *) const
+{
+    expression = CompiledExpression(code, [](Environment *)
+                                    { return Value(); });
+    return Value();
+}
+
+Value ClosureCompiler::visitUnaryExpression(Environment *, const Unary *expr) const
+{
+    CompiledExpression right = compile(expr->right);
+    const Token *token = expr->op;
+
+    switch (token->type)
+    {
+    case TokenType::BANG:
+        expression = CompiledExpression(code, [right](Environment *env)
+                                        { return Value(!Interpreter::isTruthy(right(env))); });
+        break;
+    case TokenType::MINUS:
+        expression = CompiledExpression(code, [right, token](Environment *env)
+                                        {
+                                            Value r = right(env);
+
+                                            if (!r.isNumber())
+                                                throw RuntimeError(*token, "Operand must be a number.");
+
+                                            return Value(-r.asNumber()); });
+        break;
+    default:
+        expression = CompiledExpression(code, [right](Environment *env)
+                                        {
+                                            right(env);
+                                            return Value(); });
+    }
+
+    return Value();
+}
+
+Value ClosureCompiler::visitVariableExpression(Environment *, const Variable *expr) const
+{
+    if (expr->upvalue >= 0)
+    {
+        int upvalue = expr->upvalue;
+
+        expression = CompiledExpression(code, [upvalue](Environment *env)
+                                        { return env->getUpvalue(upvalue); });
+    }
+    else if (expr->slot.isGlobal())
+    {
+        // A global is found by name once it's defined, and through its
+        // location from then on.
+        const Token *name = expr->name;
+        Value **global = code.make<Value *>(nullptr);
+
+        expression = CompiledExpression(code, [this, name, global](Environment *)
+                                        {
+                                            if (*global == nullptr)
+                                                *global = globals->find(*name);
+
+                                            return *global != nullptr ? **global : globals->get(*name); });
+    }
+    else
+    {
+        Slot slot = locate(expr->slot);
+
+        expression = CompiledExpression(code, [slot](Environment *env)
+                                        { return env->getAt(slot); });
+    }
+
+    return Value();
+}
+
+#undef NUMBER_OP
+#undef NUMBER_CONSTANT_OP
+
+/*
+STATEMENTS
+*/
+
+Completion ClosureCompiler::visitBlockStatement(Environment *, const Block *stmt) const
+{
+    int scopeSize = stmt->scopeSize;
+
+    scopes.push_back(scopeSize > 0);
+    CompiledStatement body = compileBody(stmt->statements);
+    scopes.pop_back();
+
+    if (scopeSize == 0)
+    {
+        statement = body;
+        return Completion();
+    }
+
+    statement = CompiledStatement(code, [this, body, scopeSize](Environment *env)
+                                  {
+                                      Frame frame = Frame(stack, env, scopeSize);
+
+                                      frames.push_back(frame.environment);
+                                      Completion completion = body(frame.environment);
+                                      frames.pop_back();
+
+                                      return completion; });
+
+    return Completion();
+}
+
+Completion ClosureCompiler::visitClassStatement(Environment *, const Class *) const
+{
+    statement = CompiledStatement(code, [](Environment *)
+                                  { return Completion(); });
+    return Completion();
+}
+
+Completion ClosureCompiler::visitExpressionStatementStatement(Environment *, const ExpressionStatement *stmt) const
+{
+    CompiledExpression value = compile(stmt->expression);
+
+    statement = CompiledStatement(code, [value](Environment *env)
+                                  {
+                                      value(env);
+                                      return Completion(); });
+
+    return Completion();
+}
+
+Completion ClosureCompiler::visitFunctionStatement(Environment *, const Function *stmt) const
+{
+    vector<Capture> located;
+
+    for (const Capture &capture : stmt->upvalues)
+        located.push_back(capture.upvalue >= 0 ? capture : Capture{locate(capture.slot), -1});
+
+    NodeList<Capture> captures = code.list(located);
+    bool global = scopes.empty();
+
+    scopes.push_back(true);
+    CompiledStatement body = compileBody(stmt->body);
+    scopes.pop_back();
+
+    statement = CompiledStatement(code, [this, stmt, body, captures, global](Environment *env)
+                                  {
+                                      vector<Upvalue *> upvalues = vector<Upvalue *>();
+
+                                      for (const Capture &capture : captures)
+                                          upvalues.push_back(env->capture(capture));
+
+                                      Value function = Value(ValueType::FUNCTION, Heap::instance().allocate<LoxCompiledFunction>(*this, stmt, body, move(upvalues)));
+
+                                      if (global)
+                                          env->define(stmt->name->symbol, function);
+                                      else
+                                          env->define(function);
+
+                                      return Completion(); });
+
+    return Completion();
+}
+
+Completion ClosureCompiler::visitIfStatement(Environment *, const If *stmt) const
+{
+    CompiledCondition condition = compileCondition(stmt->condition);
+    CompiledStatement thenBranch = compile(stmt->thenBranch);
+
+    if (stmt->elseBranch == nullptr)
+    {
+        statement = CompiledStatement(code, [condition, thenBranch](Environment *env)
+                                      {
+                                          if (condition(env))
+                                              return thenBranch(env);
+                                          return Completion(); });
+        return Completion();
+    }
+
+    CompiledStatement elseBranch = compile(stmt->elseBranch);
+
+    statement = CompiledStatement(code, [condition, thenBranch, elseBranch](Environment *env)
+                                  {
+                                      if (condition(env))
+                                          return thenBranch(env);
+                                      return elseBranch(env); });
+
+    return Completion();
+}
+
+Completion ClosureCompiler::visitPrintStatement(Environment *, const Print *stmt) const
+{
+    CompiledExpression value = compile(stmt->expression);
+
+    statement = CompiledStatement(code, [value](Environment *env)
+                                  {
+                                      REPL::print(Interpreter::stringify(value(env)));
+                                      return Completion(); });
+
+    return Completion();
+}
+
+Completion ClosureCompiler::visitReturnStatement(Environment *, const Return *stmt) const
+{
+    if (stmt->value == nullptr)
+    {
+        statement = CompiledStatement(code, [](Environment *)
+                                      { return Completion(Value()); });
+        return Completion();
+    }
+
+    if (stmt->tailCall)
+    {
+        statement = compileTailCall(static_cast<const Call *>(stmt->value));
+        return Completion();
+    }
+
+    CompiledExpression value = compile(stmt->value);
+
+    statement = CompiledStatement(code, [value](Environment *env)
+                                  { return Completion(value(env)); });
+
+    return Completion();
+}
+
+Completion ClosureCompiler::visitVarStatement(Environment *, const Var *stmt) const
+{
+    CompiledExpression initializer = stmt->initializer != nullptr
+                                         ? compile(stmt->initializer)
+                                         : CompiledExpression(code, [](Environment *)
+                                                              { return Value(); });
+
+    if (scopes.empty())
+    {
+        const Symbol *name = stmt->name->symbol;
+
+        statement = CompiledStatement(code, [initializer, name](Environment *env)
+                                      {
+                                          env->define(name, initializer(env));
+                                          return Completion(); });
+    }
+    else
+    {
+        statement = CompiledStatement(code, [initializer](Environment *env)
+                                      {
+                                          env->define(initializer(env));
+                                          return Completion(); });
+    }
+
+    return Completion();
+}
+
+Completion ClosureCompiler::visitWhileStatement(Environment *, const While *stmt) const
+{
+    CompiledCondition condition = compileCondition(stmt->condition);
+    CompiledStatement body = compile(stmt->body);
+
+    statement = CompiledStatement(code, [condition, body](Environment *env)
+                                  {
+                                      while (condition(env))
+                                      {
+                                          Completion completion = body(env);
+
+                                          if (completion.isReturn())
+                                              return completion;
+                                      }
+
+                                      return Completion(); });
+
+    return Completion();
+}
+
+/*
+OTHER
+*/
+
+void ClosureCompiler::interpret(std::vector<const Statement *> &statements)
+{
+    vector<CompiledStatement> program;
+
+    for (const Statement *stmt : statements)
+        program.push_back(compile(stmt));
+
+    try
+    {
+        for (const CompiledStatement &statement : program)
+            statement(globals);
+    }
+    catch (RuntimeError &error)
+    {
+        REPL::runtimeError(error);
+        frames.clear();
+    }
+}
+
+void ClosureCompiler::markRoots(Heap &heap) const
+{
+    heap.mark(globals);
+
+    for (Environment *frame : frames)
+        heap.mark(frame);
+}
@@ -0,0 +1,157 @@
+#ifndef _CLOSURE_COMPILER_HPP
+#define _CLOSURE_COMPILER_HPP
+
+#include <ast/expression.hpp>
+#include <ast/statement.hpp>
+#include <ast/callable.hpp>
+#include <ast/completion.hpp>
+#include <ast/value.hpp>
+#include <environment/environment.hpp>
+#include <interpreter/interpreter.hpp>
+#include <heap/heap.hpp>
+#include <memory>
+#include <vector>
+#include <string>
+
+namespace Lox
+{
+    // A node lowered to a function that does its own work directly, with
+    // its children and operator already bound in. What it binds lives in
+    // the engine's arena, so running a node is a single indirect call.
+    template <typename R>
+    class Compiled
+    {
+    private:
+        R (*function)(const void *state, Environment *env);
+        const void *state;
+
+    public:
+        Compiled(void) : function(nullptr), state(nullptr){};
+
+        template <typename F>
+        Compiled(Arena &arena, F lambda)
+            : function([](const void *state, Environment *env) -> R
+                       { return (*static_cast<const F *>(state))(env); }),
+              state(arena.make<F>(std::move(lambda))){};
+
+        R operator()(Environment *env) const { return function(state, env); };
+    };
+
+    typedef Compiled<Value> CompiledExpression;
+    typedef Compiled<Completion> CompiledStatement;
+    // The truthiness of an expression, for the conditions of ifs and loops.
+    typedef Compiled<bool> CompiledCondition;
+
+    class ClosureCompiler;
+
+    class LoxCompiledFunction : public LoxCallable
+    {
+    private:
+        const ClosureCompiler &engine;
+
+    public:
+        const Function *declaration;
+        const CompiledStatement body;
+        const std::vector<Upvalue *> upvalues;
+
+        LoxCompiledFunction(const ClosureCompiler &engine,
+                            const Function *declaration,
+                            CompiledStatement body,
+                            std::vector<Upvalue *> upvalues)
+            : engine(engine), declaration(declaration), body(body), upvalues(std::move(upvalues))
+        {
+        }
+
+        long unsigned int arity(void) const override
+        {
+            return declaration->params.size();
+        }
+
+        Value call(const Interpreter &interpreter, Arguments args) override;
+
+        void trace(Heap &heap) const override
+        {
+            for (Upvalue *upvalue : upvalues)
+                heap.mark(upvalue);
+        }
+
+        std::string toString(void) const override
+        {
+            return "<fn " + std::string(declaration->name->lexeme) + ">";
+        }
+    };
+
+    // Runs resolved programs by first turning every node into a closure
+    // specialised on its kind, operator and operands, so executing a node is
+    // a single indirect call instead of accept, visit and a switch on the
+    // operator. Frames, upvalues, arguments and error messages are the same
+    // as the Interpreter's.
+    class ClosureCompiler : public ExpressionVisitor,
+                            public StatementVisitor,
+                            public RootSet
+    {
+    private:
+        // Environments of the blocks and calls currently executing.
+        mutable std::vector<Environment *> frames;
+        // Whether each scope around the node being compiled has an
+        // Environment. Blocks that declare nothing run in the enclosing one.
+        mutable std::vector<bool> scopes;
+        // Owns what the compiled nodes bind, for as long as the engine runs.
+        mutable Arena code;
+        FrameStack stack;
+        ArgumentStack arguments;
+        CallDepth calls;
+        // Output of the last accept().
+        mutable CompiledExpression expression;
+        mutable CompiledStatement statement;
+
+        CompiledExpression compile(const Expression *expr) const;
+        CompiledStatement compile(const Statement *stmt) const;
+        CompiledCondition compileCondition(const Expression *expr) const;
+        CompiledStatement compileBody(NodeList<const Statement *> statements) const;
+        Slot locate(const Slot &slot) const;
+        Value call(const Token *paren, const Value &callee, Arguments args) const;
+        CompiledStatement compileTailCall(const Call *expr) const;
+        Completion run(const LoxCompiledFunction &function, Arguments args) const;
+
+    public:
+        Environment *const globals;
+
+        ClosureCompiler(void);
+        ~ClosureCompiler(void);
+        void setMaxDepth(size_t depth);
+
+        Value invoke(const LoxCompiledFunction &function, Arguments args) const;
+
+        // EXPRESSIONS
+        Value visitAssignExpression(Environment *env, const Assign *expr) const override;
+        Value visitBinaryExpression(Environment *env, const Binary *expr) const override;
+        Value visitCallExpression(Environment *env, const Call *expr) const override;
+        Value visitGetExpression(Environment *env, const Get *expr) const override;
+        Value visitGroupingExpression(Environment *env, const Grouping *expr) const override;
+        Value visitLiteralExpression(Environment *env, const Literal *expr) const override;
+        Value visitLogicalExpression(Environment *env, const Logical *expr) const override;
+        Value visitSetExpression(Environment *env, const Set *expr) const override;
+        Value visitSuperExpression(Environment *env, const Super *expr) const override;
+        Value visitThisExpression(Environment *env, const This *expr) const override;
+        Value visitUnaryExpression(Environment *env, const Unary *expr) const override;
+        Value visitVariableExpression(Environment *env, const Variable *expr) const override;
+
+        // STATEMENTS
+        Completion visitBlockStatement(Environment *env, const Block *stmt) const override;
+        Completion visitClassStatement(Environment *env, const Class *stmt) const override;
+        Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const override;
+        Completion visitFunctionStatement(Environment *env, const Function *stmt) const override;
+        Completion visitIfStatement(Environment *env, const If *stmt) const override;
+        Completion visitPrintStatement(Environment *env, const Print *stmt) const override;
+        Completion visitReturnStatement(Environment *env, const Return *stmt) const override;
+        Completion visitVarStatement(Environment *env, const Var *stmt) const override;
+        Completion visitWhileStatement(Environment *env, const While *stmt) const override;
+
+        // OTHER
+        void interpret(std::vector<const Statement *> &statements);
+        void markRoots(Heap &heap) const override;
+    };
+}
+
+#endif
@@ -0,0 +1,596 @@
+#include <compiler/compiler.hpp>
+#include <repl/repl.hpp>
+
+using namespace Lox;
+using namespace std;
+
+Compiler::Compiler(VM &vm)
+    : vm(vm),
+      functions(make_shared<deque<FunctionState>>()),
+      line(new int(0))
+{
+    Heap::instance().addRoots(this);
+}
+
+Compiler::~Compiler(void)
+{
+    Heap::instance().removeRoots(this);
+}
+
+/*
+PRIVATE
+*/
+
+Compiler::FunctionState &Compiler::current(void) const
+{
+    return functions->back();
+}
+
+Chunk &Compiler::currentChunk(void) const
+{
+    return static_cast<LoxPrototype *>(current().function.asObject())->chunk;
+}
+
+void Compiler::emit(uint8_t byte) const
+{
+    currentChunk().write(byte, *line);
+}
+
+void Compiler::emit(OpCode op) const
+{
+    currentChunk().write(op, *line);
+}
+
+void Compiler::emit(OpCode op, uint8_t operand) const
+{
+    emit(op);
+    emit(operand);
+}
+
+void Compiler::emitShort(OpCode op, int operand) const
+{
+    emit(op);
+    emit((uint8_t)((operand >> 8) & 0xff));
+    emit((uint8_t)(operand & 0xff));
+}
+
+int Compiler::emitJump(OpCode op) const
+{
+    emitShort(op, 0xffff);
+    return currentChunk().code.size() - 2;
+}
+
+void Compiler::patchJump(int offset) const
+{
+    Chunk &chunk = currentChunk();
+    int jump = chunk.code.size() - offset - 2;
+
+    if (jump > UINT16_MAX)
+        REPL::error(*line, "Too much code to jump over.");
+
+    chunk.code[offset] = (jump >> 8) & 0xff;
+    chunk.code[offset + 1] = jump & 0xff;
+}
+
+void Compiler::emitLoop(int loopStart) const
+{
+    emit(OpCode::LOOP);
+
+    int offset = currentChunk().code.size() - loopStart + 2;
+
+    if (offset > UINT16_MAX)
+        REPL::error(*line, "Loop body too large.");
+
+    emit((uint8_t)((offset >> 8) & 0xff));
+    emit((uint8_t)(offset & 0xff));
+}
+
+int Compiler::makeConstant(const Value &value) const
+{
+    int constant = currentChunk().addConstant(value);
+
+    if (constant > UINT16_MAX)
+    {
+        REPL::error(*line, "Too many constants in one chunk.");
+        return 0;
+    }
+    return constant;
+}
+
+void Compiler::beginFunction(const std::string &name) const
+{
+    functions->push_back(FunctionState{
+        Value(ValueType::PROTOTYPE, Heap::instance().allocate<LoxPrototype>(name)),
+        vector<Local>(),
+        vector<Upvalue>(),
+        0});
+
+    // Slot zero holds the closure being called.
+    current().locals.push_back(Local{"", 0, false});
+}
+
+Value Compiler::endFunction(void) const
+{
+    emit(OpCode::NIL);
+    emit(OpCode::RETURN);
+
+    Value function = current().function;
+    static_cast<LoxPrototype *>(function.asObject())->upvalueCount = current().upvalues.size();
+    functions->pop_back();
+
+    return function;
+}
+
+void Compiler::beginScope(void) const
+{
+    current().scopeDepth++;
+}
+
+void Compiler::endScope(void) const
+{
+    FunctionState &function = current();
+    function.scopeDepth--;
+
+    while (!function.locals.empty() && function.locals.back().depth > function.scopeDepth)
+    {
+        if (function.locals.back().isCaptured)
+            emit(OpCode::CLOSE_UPVALUE);
+        else
+            emit(OpCode::POP);
+
+        function.locals.pop_back();
+    }
+}
+
+void Compiler::declareLocal(const Token &name) const
+{
+    if (current().scopeDepth == 0)
+        return;
+
+    if (current().locals.size() > UINT8_MAX)
+    {
+        REPL::error(name, "Too many local variables in function.");
+        return;
+    }
+
+    current().locals.push_back(Local{name.lexeme, -1, false});
+}
+
+void Compiler::markInitialized(void) const
+{
+    if (current().scopeDepth == 0)
+        return;
+
+    current().locals.back().depth = current().scopeDepth;
+}
+
+int Compiler::resolveLocal(int function, std::string_view name) const
+{
+    vector<Local> &locals = (*functions)[function].locals;
+
+    for (int i = locals.size() - 1; i >= 0; i--)
+        if (locals[i].name == name)
+            return i;
+
+    return -1;
+}
+
+int Compiler::addUpvalue(int function, uint8_t index, bool isLocal) const
+{
+    vector<Upvalue> &upvalues = (*functions)[function].upvalues;
+
+    for (size_t i = 0; i < upvalues.size(); i++)
+        if (upvalues[i].index == index && upvalues[i].isLocal == isLocal)
+            return i;
+
+    if (upvalues.size() > UINT8_MAX)
+    {
+        REPL::error(*line, "Too many closure variables in function.");
+        return 0;
+    }
+
+    upvalues.push_back(Upvalue{index, isLocal});
+    return upvalues.size() - 1;
+}
+
+int Compiler::resolveUpvalue(int function, std::string_view name) const
+{
+    if (function == 0)
+        return -1;
+
+    int local = resolveLocal(function - 1, name);
+
+    if (local != -1)
+    {
+        (*functions)[function - 1].locals[local].isCaptured = true;
+        return addUpvalue(function, (uint8_t)local, true);
+    }
+
+    int upvalue = resolveUpvalue(function - 1, name);
+
+    if (upvalue != -1)
+        return addUpvalue(function, (uint8_t)upvalue, false);
+
+    return -1;
+}
+
+void Compiler::namedVariable(const Token &name, bool assign) const
+{
+    int function = functions->size() - 1;
+    int arg = resolveLocal(function, name.lexeme);
+
+    if (arg != -1)
+    {
+        emit(assign ? OpCode::SET_LOCAL : OpCode::GET_LOCAL, (uint8_t)arg);
+        return;
+    }
+
+    arg = resolveUpvalue(function, name.lexeme);
+
+    if (arg != -1)
+    {
+        emit(assign ? OpCode::SET_UPVALUE : OpCode::GET_UPVALUE, (uint8_t)arg);
+        return;
+    }
+
+    emitShort(assign ? OpCode::SET_GLOBAL : OpCode::GET_GLOBAL, vm.globalSlot(string(name.lexeme)));
+}
+
+void Compiler::compile(const Expression *expr) const
+{
+    expr->accept(nullptr, *this);
+}
+
+void Compiler::compile(const Statement *stmt) const
+{
+    stmt->accept(nullptr, *this);
+}
+
+void Compiler::compileFunction(const Function *stmt) const
+{
+    beginFunction(string(stmt->name->lexeme));
+    beginScope();
+
+    LoxPrototype *prototype = static_cast<LoxPrototype *>(current().function.asObject());
+    prototype->arity = stmt->params.size();
+
+    for (auto param : stmt->params)
+    {
+        declareLocal(*param);
+        markInitialized();
+    }
+
+    for (auto statement : stmt->body)
+        compile(statement);
+
+    vector<Upvalue> upvalues = current().upvalues;
+    Value function = endFunction();
+
+    *line = stmt->name->line;
+    emitShort(OpCode::CLOSURE, makeConstant(function));
+
+    for (auto upvalue : upvalues)
+    {
+        emit((uint8_t)(upvalue.isLocal ? 1 : 0));
+        emit(upvalue.index);
+    }
+}
+
+/*
+EXPRESSIONS
+*/
+
+Value Compiler::visitAssignExpression(Environment *, const Assign *expr) const
+{
+    compile(expr->value);
+    *line = expr->name->line;
+    namedVariable(*(expr->name), true);
+    return Value();
+}
+
+Value Compiler::visitBinaryExpression(Environment *, const Binary *expr) const
+{
+    compile(expr->left);
+    compile(expr->right);
+    *line = expr->op->line;
+
+    switch (expr->op->type)
+    {
+    case TokenType::GREATER:
+        emit(OpCode::GREATER);
+        break;
+    case TokenType::GREATER_EQUAL:
+        emit(OpCode::GREATER_EQUAL);
+        break;
+    case TokenType::LESS:
+        emit(OpCode::LESS);
+        break;
+    case TokenType::LESS_EQUAL:
+        emit(OpCode::LESS_EQUAL);
+        break;
+    case TokenType::BANG_EQUAL:
+        emit(OpCode::NOT_EQUAL);
+        break;
+    case TokenType::EQUAL_EQUAL:
+        emit(OpCode::EQUAL);
+        break;
+    case TokenType::MINUS:
+        emit(OpCode::SUBTRACT);
+        break;
+    case TokenType::PLUS:
+        emit(OpCode::ADD);
+        break;
+    case TokenType::SLASH:
+        emit(OpCode::DIVIDE);
+        break;
+    case TokenType::STAR:
+        emit(OpCode::MULTIPLY);
+        break;
+    default:
+        emit(OpCode::POP);
+        emit(OpCode::POP);
+        emit(OpCode::NIL);
+    }
+    return Value();
+}
+
+Value Compiler::visitCallExpression(Environment *, const Call *expr) const
+{
+    compile(expr->callee);
+
+    for (auto arg : expr->arguments)
+        compile(arg);
+
+    *line = expr->paren->line;
+    emit(OpCode::CALL, (uint8_t)expr->arguments.size());
+    return Value();
+}
+
+Value Compiler::visitGetExpression(Environment *, const Get *) const
+{
+    emit(OpCode::NIL);
+    return Value();
+}
+
+Value Compiler::visitGroupingExpression(Environment *, const Grouping *expr) const
+{
+    compile(expr->expression);
+    return Value();
+}
+
+Value Compiler::visitLiteralExpression(Environment *, const Literal *expr) const
+{
+    switch (expr->value.type)
+    {
+    case ValueType::STRING:
+    case ValueType::NUMBER:
+        emitShort(OpCode::CONSTANT, makeConstant(expr->value));
+        break;
+    case ValueType::BOOLEAN:
+        emit(expr->value.asBoolean() ? OpCode::TRUE : OpCode::FALSE);
+        break;
+    default:
+        emit(OpCode::NIL);
+    }
+    return Value();
+}
+
+Value Compiler::visitLogicalExpression(Environment *, const Logical *expr) const
+{
+    compile(expr->left);
+    *line = expr->op->line;
+
+    if (expr->op->type == TokenType::OR)
+    {
+        int elseJump = emitJump(OpCode::JUMP_IF_FALSE);
+        int endJump = emitJump(OpCode::JUMP);
+
+        patchJump(elseJump);
+        emit(OpCode::POP);
+        compile(expr->right);
+        patchJump(endJump);
+    }
+    else
+    {
+        int endJump = emitJump(OpCode::JUMP_IF_FALSE);
+
+        emit(OpCode::POP);
+        compile(expr->right);
+        patchJump(endJump);
+    }
+    return Value();
+}
+
+Value Compiler::visitSetExpression(Environment *, const Set *) const
+{
+    emit(OpCode::NIL);
+    return Value();
+}
+
+Value Compiler::visitSuperExpression(Environment *, const Super *) const
+{
+    emit(OpCode::NIL);
+    return Value();
+}
+
+Value Compiler::visitThisExpression(Environment *, const This *) const
+{
+    emit(OpCode::NIL);
+    return Value();
+}
+
+Value Compiler::visitUnaryExpression(Environment *, const Unary *expr) const
+{
+    compile(expr->right);
+    *line = expr->op->line;
+
+    switch (expr->op->type)
+    {
+    case TokenType::BANG:
+        emit(OpCode::NOT);
+        break;
+    case TokenType::MINUS:
+        emit(OpCode::NEGATE);
+        break;
+    default:
+        emit(OpCode::POP);
+        emit(OpCode::NIL);
+    }
+    return Value();
+}
+
+Value Compiler::visitVariableExpression(Environment *, const Variable *expr) const
+{
+    *line = expr->name->line;
+    namedVariable(*(expr->name), false);
+    return Value();
+}
+
+/*
+STATEMENTS
+*/
+
+Completion Compiler::visitBlockStatement(Environment *, const Block *stmt) const
+{
+    beginScope();
+
+    for (auto statement : stmt->statements)
+        compile(statement);
+
+    endScope();
+    return Completion();
+}
+
+Completion Compiler::visitClassStatement(Environment *, const Class *) const
+{
+    return Completion();
+}
+
+Completion Compiler::visitExpressionStatementStatement(Environment *, const ExpressionStatement *stmt) const
+{
+    compile(stmt->expression);
+    emit(OpCode::POP);
+    return Completion();
+}
+
+Completion Compiler::visitFunctionStatement(Environment *, const Function *stmt) const
+{
+    *line = stmt->name->line;
+    declareLocal(*(stmt->name));
+    markInitialized();
+
+    compileFunction(stmt);
+
+    if (current().scopeDepth == 0)
+        emitShort(OpCode::DEFINE_GLOBAL, vm.globalSlot(string(stmt->name->lexeme)));
+
+    return Completion();
+}
+
+Completion Compiler::visitIfStatement(Environment *, const If *stmt) const
+{
+    compile(stmt->condition);
+
+    int thenJump = emitJump(OpCode::JUMP_IF_FALSE);
+    emit(OpCode::POP);
+    compile(stmt->thenBranch);
+
+    int elseJump = emitJump(OpCode::JUMP);
+    patchJump(thenJump);
+    emit(OpCode::POP);
+
+    if (stmt->elseBranch != nullptr)
+        compile(stmt->elseBranch);
+
+    patchJump(elseJump);
+    return Completion();
+}
+
+Completion Compiler::visitPrintStatement(Environment *, const Print *stmt) const
+{
+    compile(stmt->expression);
+    emit(OpCode::PRINT);
+    return Completion();
+}
+
+Completion Compiler::visitReturnStatement(Environment *, const Return *stmt) const
+{
+    *line = stmt->keyword->line;
+
+    if (stmt->tailCall)
+    {
+        // The RETURN only runs if the callee can't take over the frame.
+        auto call = static_cast<const Call *>(stmt->value);
+
+        compile(call->callee);
+
+        for (auto arg : call->arguments)
+            compile(arg);
+
+        *line = call->paren->line;
+        emit(OpCode::TAIL_CALL, (uint8_t)call->arguments.size());
+    }
+    else if (stmt->value != nullptr)
+        compile(stmt->value);
+    else
+        emit(OpCode::NIL);
+
+    emit(OpCode::RETURN);
+    return Completion();
+}
+
+Completion Compiler::visitVarStatement(Environment *, const Var *stmt) const
+{
+    *line = stmt->name->line;
+    declareLocal(*(stmt->name));
+
+    if (stmt->initializer != nullptr)
+        compile(stmt->initializer);
+    else
+        emit(OpCode::NIL);
+
+    *line = stmt->name->line;
+
+    if (current().scopeDepth == 0)
+        emitShort(OpCode::DEFINE_GLOBAL, vm.globalSlot(string(stmt->name->lexeme)));
+    else
+        markInitialized();
+
+    return Completion();
+}
+
+Completion Compiler::visitWhileStatement(Environment *, const While *stmt) const
+{
+    int loopStart = currentChunk().code.size();
+    compile(stmt->condition);
+
+    int exitJump = emitJump(OpCode::JUMP_IF_FALSE);
+    emit(OpCode::POP);
+    compile(stmt->body);
+    emitLoop(loopStart);
+
+    patchJump(exitJump);
+    emit(OpCode::POP);
+    return Completion();
+}
+
+/*
+OTHER
+*/
+
+Value Compiler::compile(vector<const Statement *> &statements)
+{
+    beginFunction("");
+
+    for (auto stmt : statements)
+        compile(stmt);
+
+    return endFunction();
+}
+
+void Compiler::markRoots(Heap &heap) const
+{
+    // Functions still being compiled are only reachable from here.
+    for (const FunctionState &function : *functions)
+        heap.mark(function.function);
+}
@@ -0,0 +1,112 @@
+#ifndef _COMPILER_HPP
+#define _COMPILER_HPP
+
+#include <ast/expression.hpp>
+#include <ast/statement.hpp>
+#include <ast/value.hpp>
+#include <vm/chunk.hpp>
+#include <vm/closure.hpp>
+#include <vm/vm.hpp>
+#include <heap/heap.hpp>
+#include <any>
+#include <memory>
+#include <deque>
+#include <vector>
+#include <string>
+#include <string_view>
+
+namespace Lox
+{
+    // Lowers a resolved program into bytecode for the VM. Static errors have
+    // already been reported by the Resolver, so the compiler only assigns
+    // stack slots, upvalues and global slots.
+    class Compiler : public ExpressionVisitor,
+                     public StatementVisitor,
+                     public RootSet
+    {
+    private:
+        struct Local
+        {
+            std::string_view name;
+            int depth;
+            bool isCaptured;
+        };
+
+        struct Upvalue
+        {
+            uint8_t index;
+            bool isLocal;
+        };
+
+        struct FunctionState
+        {
+            Value function;
+            std::vector<Local> locals;
+            std::vector<Upvalue> upvalues;
+            int scopeDepth;
+        };
+
+        VM &vm;
+        const std::shared_ptr<std::deque<FunctionState>> functions;
+        std::unique_ptr<int> line;
+
+        FunctionState &current(void) const;
+        Chunk &currentChunk(void) const;
+        void emit(uint8_t byte) const;
+        void emit(OpCode op) const;
+        void emit(OpCode op, uint8_t operand) const;
+        void emitShort(OpCode op, int operand) const;
+        int emitJump(OpCode op) const;
+        void patchJump(int offset) const;
+        void emitLoop(int loopStart) const;
+        int makeConstant(const Value &value) const;
+        void beginFunction(const std::string &name) const;
+        Value endFunction(void) const;
+        void beginScope(void) const;
+        void endScope(void) const;
+        void declareLocal(const Token &name) const;
+        void markInitialized(void) const;
+        int resolveLocal(int function, std::string_view name) const;
+        int addUpvalue(int function, uint8_t index, bool isLocal) const;
+        int resolveUpvalue(int function, std::string_view name) const;
+        void namedVariable(const Token &name, bool assign) const;
+        void compile(const Expression *expr) const;
+        void compile(const Statement *stmt) const;
+        void compileFunction(const Function *stmt) const;
+
+    public:
+        Compiler(VM &vm);
+        ~Compiler(void);
+
+        // EXPRESSIONS
+        Value visitAssignExpression(Environment *env, const Assign *expr) const override;
+        Value visitBinaryExpression(Environment *env, const Binary *expr) const override;
+        Value visitCallExpression(Environment *env, const Call *expr) const override;
+        Value visitGetExpression(Environment *env, const Get *expr) const override;
+        Value visitGroupingExpression(Environment *env, const Grouping *expr) const override;
+        Value visitLiteralExpression(Environment *env, const Literal *expr) const override;
+        Value visitLogicalExpression(Environment *env, const Logical *expr) const override;
+        Value visitSetExpression(Environment *env, const Set *expr) const override;
+        Value visitSuperExpression(Environment *env, const Super *expr) const override;
+        Value visitThisExpression(Environment *env, const This *expr) const override;
+        Value visitUnaryExpression(Environment *env, const Unary *expr) const override;
+        Value visitVariableExpression(Environment *env, const Variable *expr) const override;
+
+        // STATEMENTS
+        Completion visitBlockStatement(Environment *env, const Block *stmt) const override;
+        Completion visitClassStatement(Environment *env, const Class *stmt) const override;
+        Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const override;
+        Completion visitFunctionStatement(Environment *env, const Function *stmt) const override;
+        Completion visitIfStatement(Environment *env, const If *stmt) const override;
+        Completion visitPrintStatement(Environment *env, const Print *stmt) const override;
+        Completion visitReturnStatement(Environment *env, const Return *stmt) const override;
+        Completion visitVarStatement(Environment *env, const Var *stmt) const override;
+        Completion visitWhileStatement(Environment *env, const While *stmt) const override;
+
+        // OTHER
+        Value compile(std::vector<const Statement *> &statements);
+        void markRoots(Heap &heap) const override;
+    };
+}
+
+#endif
@@ -1,29 +1,60 @@
 #include <environment/environment.hpp>
 #include <interpreter/interpreter.hpp>
+#include <heap/heap.hpp>
 
 using namespace Lox;
 using namespace std;
 
+void Upvalue::trace(Heap &heap) const
+{
+    heap.mark(closed);
+}
+
 Environment::Environment(void)
-    : values(std::unordered_map<string, std::any>()), enclosing(nullptr)
+    : values(), storage(), slots(nullptr), count(0), enclosing(nullptr),
+      upvalues(nullptr), open(nullptr)
 {
 }
 
-Environment::Environment(shared_ptr<Environment> enclosing)
-    : values(std::unordered_map<string, std::any>()), enclosing(enclosing)
+Environment::Environment(Environment *enclosing, const int size)
+    : values(), storage(size), slots(storage.data()), count(0), enclosing(enclosing),
+      upvalues(enclosing != nullptr ? enclosing->upvalues : nullptr), open(nullptr)
 {
 }
 
-void Environment::define(const string &name, const std::any &value)
+Environment::Environment(Environment *enclosing, Value *slots)
+    : values(), storage(), slots(slots), count(0), enclosing(enclosing),
+      upvalues(enclosing != nullptr ? enclosing->upvalues : nullptr), open(nullptr)
+{
+    // Frame environments are never swept, so they start out marked and the
+    // collector never queues them. The FrameStack traces them instead.
+    marked = true;
+}
+
+void Environment::define(const Symbol *name, const Value &value)
 {
     values[name] = value;
 }
 
-void Environment::assign(const Token &name, const std::any &value)
+void Environment::define(string_view name, const Value &value)
 {
-    if (values.find(name.lexeme) != values.end())
+    define(Symbol::intern(name), value);
+}
+
+void Environment::define(const Value &value)
+{
+    // Declarations in a scope execute in the order the resolver numbered
+    // them, so the next slot is always the one being defined.
+    slots[count++] = value;
+}
+
+void Environment::assign(const Token &name, const Value &value)
+{
+    auto search = values.find(name.symbol);
+
+    if (search != values.end())
     {
-        values[name.lexeme] = value;
+        search->second = value;
         return;
     }
 
@@ -32,24 +63,17 @@ void Environment::assign(const Token &name, const std::any &value)
         enclosing->assign(name, value);
         return;
     }
-    throw RuntimeError(name, "Undefined variable '" + name.lexeme + "'.");
+    throw RuntimeError(name, "Undefined variable '" + string(name.lexeme) + "'.");
 }
 
-void Environment::assignAt(const int distance, const Token &name, const std::any &value)
+void Environment::assignAt(const Slot &slot, const Value &value)
 {
-    Environment *env = ancestor(distance);
-
-    if (env->values.find(name.lexeme) != env->values.end())
-    {
-        env->values[name.lexeme] = value;
-        return;
-    }
-    throw RuntimeError(name, "Undefined variable '" + name.lexeme + "'.");
+    ancestor(slot.depth)->slots[slot.index] = value;
 }
 
-std::any Environment::get(const Token &name)
+Value Environment::get(const Token &name)
 {
-    auto search = values.find(name.lexeme);
+    auto search = values.find(name.symbol);
 
     if (search != values.end())
         return search->second;
@@ -57,19 +81,66 @@ std::any Environment::get(const Token &name)
     if (enclosing != nullptr)
         return enclosing->get(name);
 
-    throw RuntimeError(name, "Undefined global variable '" + name.lexeme + "'.");
+    throw RuntimeError(name, "Undefined global variable '" + string(name.lexeme) + "'.");
 }
 
-std::any Environment::getAt(const int distance, const Token &name)
+Value *Environment::find(const Token &name)
 {
-    Environment *env = ancestor(distance);
+    auto search = values.find(name.symbol);
 
-    auto search = env->values.find(name.lexeme);
+    return search != values.end() ? &search->second : nullptr;
+}
 
-    if (search != values.end())
-        return search->second;
+Value Environment::getAt(const Slot &slot)
+{
+    return ancestor(slot.depth)->slots[slot.index];
+}
 
-    throw RuntimeError(name, "Undefined local variable '" + name.lexeme + "'.");
+void Environment::setUpvalues(Upvalue *const *upvalues)
+{
+    this->upvalues = upvalues;
+}
+
+Value Environment::getUpvalue(const int index)
+{
+    return *upvalues[index]->location;
+}
+
+void Environment::assignUpvalue(const int index, const Value &value)
+{
+    *upvalues[index]->location = value;
+}
+
+Upvalue *Environment::capture(const Capture &capture)
+{
+    if (capture.upvalue >= 0)
+        return upvalues[capture.upvalue];
+
+    Environment *env = ancestor(capture.slot.depth);
+    Value *location = &env->slots[capture.slot.index];
+
+    // Closures over the same variable share its upvalue.
+    for (Upvalue *upvalue = env->open; upvalue != nullptr; upvalue = upvalue->next)
+        if (upvalue->location == location)
+            return upvalue;
+
+    Upvalue *upvalue = Heap::instance().allocate<Upvalue>(location);
+    upvalue->next = env->open;
+    env->open = upvalue;
+
+    return upvalue;
+}
+
+void Environment::close(void)
+{
+    while (open != nullptr)
+    {
+        Upvalue *upvalue = open;
+        upvalue->closed = *upvalue->location;
+        upvalue->location = &upvalue->closed;
+        open = upvalue->next;
+        upvalue->next = nullptr;
+    }
 }
 
 Environment *Environment::ancestor(const int distance)
@@ -77,7 +148,21 @@ Environment *Environment::ancestor(const int distance)
     Environment *env = this;
 
     for (int i = 0; i < distance; i++)
-        env = &(*env->enclosing);
+        env = env->enclosing;
 
     return env;
-}
\ No newline at end of file
+}
+
+void Environment::trace(Heap &heap) const
+{
+    heap.mark(enclosing);
+
+    for (Upvalue *upvalue = open; upvalue != nullptr; upvalue = upvalue->next)
+        heap.mark(upvalue);
+
+    for (int i = 0; i < count; i++)
+        heap.mark(slots[i]);
+
+    for (auto &entry : values)
+        heap.mark(entry.second);
+}
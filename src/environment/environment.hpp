@@ -2,30 +2,87 @@
 #define _ENVIRONMENT_HPP
 
 #include <scanner/token.hpp>
+#include <scanner/symbol.hpp>
+#include <ast/object.hpp>
+#include <ast/value.hpp>
 #include <unordered_map>
+#include <vector>
 #include <string>
-#include <memory>
-#include <any>
 
 namespace Lox
 {
-    class Environment
+    // Where the resolver found a local: how many scopes up, and which slot.
+    // A negative depth means the name was left unresolved, ie. it is global.
+    struct Slot
+    {
+        int depth = -1;
+        int index = -1;
+
+        bool isGlobal(void) const { return depth < 0; };
+    };
+
+    // How a closure finds a variable it refers to when it is created: in a
+    // scope of the function declaring it, or among that function's own
+    // upvalues when upvalue isn't negative.
+    struct Capture
+    {
+        Slot slot;
+        int upvalue = -1;
+    };
+
+    // A variable a closure refers to. It points at the variable's slot while
+    // the scope declaring it runs, and holds the value once the scope ends.
+    class Upvalue : public HeapObject
+    {
+    public:
+        Value *location;
+        Value closed;
+        // The next open upvalue into the same scope.
+        Upvalue *next;
+
+        Upvalue(Value *location) : location(location), closed(), next(nullptr){};
+        void trace(Heap &heap) const override;
+    };
+
+    class Environment : public HeapObject
     {
     private:
-        std::unordered_map<std::string, std::any> values;
-        std::shared_ptr<Environment> enclosing;
+        // Only the global environment is keyed by name, every local scope
+        // is a slot array sized by the resolver.
+        std::unordered_map<const Symbol *, Value, SymbolHash> values;
+        // Heap environments own their slots, frame environments use a
+        // range of the FrameStack.
+        std::vector<Value> storage;
+        Value *slots;
+        int count;
+        Environment *enclosing;
+        // The upvalues of the function whose call this scope belongs to.
+        Upvalue *const *upvalues;
+        Upvalue *open;
 
         Environment *ancestor(const int distance);
 
     public:
         Environment(void);
-        Environment(std::shared_ptr<Environment> enclosing);
-        void define(const std::string &name, const std::any &value);
-        void assign(const Token &name, const std::any &value);
-        void assignAt(const int distance, const Token &name, const std::any &value);
-        std::any get(const Token &name);
-        std::any getAt(const int distance, const Token &name);
+        Environment(Environment *enclosing, const int size);
+        Environment(Environment *enclosing, Value *slots);
+        void define(const Symbol *name, const Value &value);
+        void define(std::string_view name, const Value &value);
+        void define(const Value &value);
+        void assign(const Token &name, const Value &value);
+        void assignAt(const Slot &slot, const Value &value);
+        Value get(const Token &name);
+        // Where a name defined in this environment keeps its value, or
+        // nullptr. Names are never removed, so the location stays valid.
+        Value *find(const Token &name);
+        Value getAt(const Slot &slot);
+        void setUpvalues(Upvalue *const *upvalues);
+        Value getUpvalue(const int index);
+        void assignUpvalue(const int index, const Value &value);
+        Upvalue *capture(const Capture &capture);
+        void close(void);
+        void trace(Heap &heap) const override;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
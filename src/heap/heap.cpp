@@ -0,0 +1,213 @@
+#include <heap/heap.hpp>
+#include <algorithm>
+
+using namespace Lox;
+using namespace std;
+
+Heap::Heap(void)
+    : objects(nullptr), bytesAllocated(0), nextCollection(MIN_THRESHOLD)
+{
+}
+
+Heap::~Heap(void)
+{
+    while (objects != nullptr)
+    {
+        HeapObject *next = objects->next;
+        delete objects;
+        objects = next;
+    }
+}
+
+/*
+PRIVATE
+*/
+
+void Heap::track(HeapObject *object, size_t size)
+{
+    object->size = size;
+    object->next = objects;
+    objects = object;
+    bytesAllocated += size;
+}
+
+void Heap::blacken(void)
+{
+    while (!gray.empty())
+    {
+        HeapObject *object = gray.back();
+        gray.pop_back();
+        object->trace(*this);
+    }
+}
+
+void Heap::sweep(void)
+{
+    HeapObject **link = &objects;
+
+    while (*link != nullptr)
+    {
+        HeapObject *object = *link;
+
+        if (object->marked)
+        {
+            object->marked = false;
+            link = &object->next;
+            continue;
+        }
+
+        *link = object->next;
+        bytesAllocated -= object->size;
+        delete object;
+    }
+}
+
+Value Heap::intern(std::string &&chars)
+{
+    size_t length = chars.size();
+    LoxString *string = allocate<LoxString>(std::move(chars));
+
+    string->size += length;
+    bytesAllocated += length;
+    string->interned = true;
+    strings.emplace(std::string_view(string->text()), string);
+    return Value(ValueType::STRING, string);
+}
+
+void Heap::sweepStrings(void)
+{
+    for (auto entry = strings.begin(); entry != strings.end();)
+    {
+        if (entry->second->marked)
+            entry++;
+        else
+            entry = strings.erase(entry);
+    }
+}
+
+/*
+PUBLIC
+*/
+
+Heap &Heap::instance(void)
+{
+    // Constructed on first use, so it outlives the REPL's static engines.
+    static Heap heap;
+    return heap;
+}
+
+Value Heap::string(std::string_view chars)
+{
+    auto search = strings.find(chars);
+
+    if (search != strings.end())
+        return Value(ValueType::STRING, search->second);
+
+    return intern(std::string(chars));
+}
+
+Value Heap::string(std::string &&chars)
+{
+    auto search = strings.find(chars);
+
+    if (search != strings.end())
+        return Value(ValueType::STRING, search->second);
+
+    // The characters of a fresh result, eg. a concatenation, are moved in.
+    return intern(std::move(chars));
+}
+
+Value Heap::constant(std::string_view chars)
+{
+    Value value = string(chars);
+
+    constants.push_back(value);
+    return value;
+}
+
+Value Heap::concat(const Value &left, const Value &right)
+{
+    const LoxString *head = static_cast<const LoxString *>(left.asObject());
+    const LoxString *tail = static_cast<const LoxString *>(right.asObject());
+
+    if (head->length + tail->length < ROPE_MIN)
+        return string(head->text() + tail->text());
+
+    // The rope refers to both halves, which must survive its allocation.
+    Scope scope;
+    push(left);
+    push(right);
+
+    return Value(ValueType::STRING, allocate<LoxString>(head, tail));
+}
+
+void Heap::addRoots(const RootSet *rootSet)
+{
+    roots.push_back(rootSet);
+}
+
+void Heap::removeRoots(const RootSet *rootSet)
+{
+    roots.erase(std::remove(roots.begin(), roots.end(), rootSet), roots.end());
+}
+
+void Heap::collect(void)
+{
+    for (const RootSet *rootSet : roots)
+        rootSet->markRoots(*this);
+
+    for (const Value &value : temps)
+        mark(value);
+
+    for (const Value &value : constants)
+        mark(value);
+
+    blacken();
+    sweepStrings();
+    sweep();
+
+    nextCollection = std::max(bytesAllocated * GROWTH_FACTOR, MIN_THRESHOLD);
+}
+
+/*
+STRINGS
+*/
+
+// Walks the rope with an explicit stack, since appending in a loop builds
+// ropes far deeper than the C++ stack.
+void LoxString::flatten(void) const
+{
+    std::string flat;
+    std::vector<const LoxString *> pending = {this};
+
+    flat.reserve(length);
+
+    while (!pending.empty())
+    {
+        const LoxString *string = pending.back();
+        pending.pop_back();
+
+        if (string->left == nullptr)
+        {
+            flat += string->chars;
+            continue;
+        }
+
+        pending.push_back(string->right);
+        pending.push_back(string->left);
+    }
+
+    chars = std::move(flat);
+    left = nullptr;
+    right = nullptr;
+
+    // The flat text is charged to the string, like that of any other.
+    const_cast<LoxString *>(this)->size += length;
+    Heap::instance().bytesAllocated += length;
+}
+
+void LoxString::trace(Heap &heap) const
+{
+    heap.mark(const_cast<LoxString *>(left));
+    heap.mark(const_cast<LoxString *>(right));
+}
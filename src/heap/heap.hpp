@@ -0,0 +1,129 @@
+#ifndef _HEAP_HPP
+#define _HEAP_HPP
+
+#include <ast/object.hpp>
+#include <ast/value.hpp>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+
+namespace Lox
+{
+    // Implemented by whatever holds values the collector can't reach from
+    // another object: the interpreter's globals and frames, the VM stack,
+    // functions the compiler is still building.
+    class RootSet
+    {
+    public:
+        virtual ~RootSet(void){};
+        virtual void markRoots(Heap &heap) const = 0;
+    };
+
+    // Owns every object, environment and upvalue. Collection is a plain
+    // mark and sweep that runs from allocate() once enough has been
+    // allocated since the last one.
+    class Heap
+    {
+    private:
+        static constexpr size_t MIN_THRESHOLD = 1024 * 1024;
+        static constexpr size_t GROWTH_FACTOR = 2;
+        // Shorter concatenations are copied and interned, longer ones are
+        // kept as ropes.
+        static constexpr size_t ROPE_MIN = 256;
+
+        HeapObject *objects;
+        size_t bytesAllocated;
+        size_t nextCollection;
+        std::vector<HeapObject *> gray;
+        std::vector<const RootSet *> roots;
+        std::vector<Value> temps;
+        // Every live string, keyed by its text. The table doesn't keep them
+        // alive; unmarked strings are dropped from it before each sweep.
+        std::unordered_map<std::string_view, LoxString *> strings;
+        // Strings of literals, which are never collected.
+        std::vector<Value> constants;
+
+        Heap(void);
+        void track(HeapObject *object, size_t size);
+        void blacken(void);
+        void sweep(void);
+        Value intern(std::string &&chars);
+        void sweepStrings(void);
+
+    public:
+        // Values pushed while a Scope is alive stay rooted until it ends,
+        // for values that only live in C++ locals between two allocations.
+        class Scope
+        {
+        private:
+            Heap &heap;
+            const size_t depth;
+
+        public:
+            Scope(void) : heap(instance()), depth(heap.temps.size()){};
+            ~Scope(void) { heap.temps.resize(depth); };
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+        };
+
+        friend class LoxString;
+
+        Heap(const Heap &) = delete;
+        Heap &operator=(const Heap &) = delete;
+        ~Heap(void);
+
+        static Heap &instance(void);
+
+        template <typename T, typename... Args>
+        T *allocate(Args &&...args)
+        {
+#ifdef DEBUG_STRESS_GC
+            collect();
+#else
+            if (bytesAllocated > nextCollection)
+                collect();
+#endif
+            T *object = new T(std::forward<Args>(args)...);
+            track(object, sizeof(T));
+            return object;
+        }
+
+        // Interned: there is one string object for any given text.
+        Value string(std::string_view chars);
+        Value string(std::string &&chars);
+        // The string for a literal. It stays alive for the whole session,
+        // like the nodes of every parse, so it can be kept in them.
+        Value constant(std::string_view chars);
+        Value concat(const Value &left, const Value &right);
+
+        void push(const Value &value)
+        {
+            if (value.isObject())
+                temps.push_back(value);
+        }
+
+        void mark(HeapObject *object)
+        {
+            if (object == nullptr || object->marked)
+                return;
+
+            object->marked = true;
+            gray.push_back(object);
+        }
+
+        void mark(const Value &value)
+        {
+            if (value.isObject())
+                mark(value.asObject());
+        }
+
+        void addRoots(const RootSet *rootSet);
+        void removeRoots(const RootSet *rootSet);
+        void collect(void);
+    };
+}
+
+#endif
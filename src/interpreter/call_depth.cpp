@@ -0,0 +1,117 @@
+#include <interpreter/call_depth.hpp>
+#include <interpreter/interpreter.hpp>
+#include <sys/resource.h>
+#include <pthread.h>
+#include <exception>
+
+using namespace Lox;
+using namespace std;
+
+// Without a limit the stack only grows until it runs into another mapping.
+static const rlim_t UNLIMITED_STACK = 256 * 1024 * 1024;
+
+// Native stack per Lox call on the tree-walker without the JIT, which uses
+// the most, with some nesting of expressions between calls.
+static const size_t CALL_STACK = 4 * 1024;
+// Left for nested expressions, primitives and reporting the error once the
+// last call fails.
+static const size_t RESERVED_STACK = 1024 * 1024;
+// Without --max-depth, room for as many calls as the VM allows.
+static const size_t DEFAULT_CALLS = 8192;
+// Beyond this the stack mapping may not be granted at all.
+static const size_t MAX_STACK = (size_t)4 * 1024 * 1024 * 1024;
+
+static const char *frameAddress(void)
+{
+    return static_cast<const char *>(__builtin_frame_address(0));
+}
+
+// Three quarters of the process's own stack, which Lox code runs on when
+// no thread of its own could be made.
+static ptrdiff_t stackRoom(void)
+{
+    struct rlimit stack;
+
+    if (getrlimit(RLIMIT_STACK, &stack) != 0 || stack.rlim_cur == RLIM_INFINITY || stack.rlim_cur > UNLIMITED_STACK)
+        stack.rlim_cur = UNLIMITED_STACK;
+
+    return stack.rlim_cur - stack.rlim_cur / 4;
+}
+
+const char *CallDepth::base = frameAddress();
+ptrdiff_t CallDepth::room = stackRoom();
+
+namespace
+{
+    struct Thread
+    {
+        const function<void(void)> &body;
+        const size_t room;
+        exception_ptr error;
+    };
+}
+
+CallDepth::CallDepth(void)
+    : limit(UNLIMITED),
+      depth(0)
+{
+}
+
+void *CallDepth::start(void *argument)
+{
+    Thread &thread = *static_cast<Thread *>(argument);
+
+    base = frameAddress();
+    room = thread.room;
+
+    try
+    {
+        thread.body();
+    }
+    catch (...)
+    {
+        thread.error = current_exception();
+    }
+
+    return nullptr;
+}
+
+void CallDepth::run(size_t limit, const function<void(void)> &body)
+{
+    size_t calls = limit == UNLIMITED ? DEFAULT_CALLS : limit;
+    size_t size = calls < (MAX_STACK - RESERVED_STACK) / CALL_STACK
+                      ? calls * CALL_STACK + RESERVED_STACK
+                      : MAX_STACK;
+
+    const char *enclosingBase = base;
+    ptrdiff_t enclosingRoom = room;
+    Thread thread = Thread{body, size - RESERVED_STACK, nullptr};
+    pthread_attr_t attributes;
+    pthread_t id;
+    bool started = false;
+
+    if (pthread_attr_init(&attributes) == 0)
+    {
+        started = pthread_attr_setstacksize(&attributes, size) == 0 &&
+                  pthread_create(&id, &attributes, start, &thread) == 0;
+        pthread_attr_destroy(&attributes);
+    }
+
+    if (!started)
+    {
+        body();
+        return;
+    }
+
+    pthread_join(id, nullptr);
+    base = enclosingBase;
+    room = enclosingRoom;
+
+    if (thread.error)
+        rethrow_exception(thread.error);
+}
+
+void CallDepth::overflow(const Token &paren) const
+{
+    throw RuntimeError(paren, "Stack overflow.");
+}
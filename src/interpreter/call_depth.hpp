@@ -0,0 +1,67 @@
+#ifndef _CALL_DEPTH_HPP
+#define _CALL_DEPTH_HPP
+
+#include <scanner/token.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace Lox
+{
+    // Counts the calls in progress in an engine that runs Lox calls as
+    // native calls. A call past the configured limit, or one that leaves too
+    // little of the native stack for what runs after it, fails with a
+    // runtime error instead of crashing the process.
+    class CallDepth
+    {
+    private:
+        // The native stack Lox code runs on, and how far past its start
+        // calls may go. Shared by every engine, since only one of them runs
+        // at a time.
+        static const char *base;
+        static ptrdiff_t room;
+
+        size_t limit;
+        mutable size_t depth;
+
+        static void *start(void *thread);
+        [[noreturn]] void overflow(const Token &paren) const;
+
+    public:
+        static const size_t UNLIMITED = SIZE_MAX;
+
+        CallDepth(void);
+        CallDepth(const CallDepth &) = delete;
+        CallDepth &operator=(const CallDepth &) = delete;
+
+        void setLimit(size_t limit) { this->limit = limit; };
+
+        // Runs body on a thread of its own, with a native stack sized for
+        // limit calls of the engine that needs the most stack per call.
+        // Exceptions body throws are rethrown here.
+        static void run(size_t limit, const std::function<void(void)> &body);
+
+        // Held for the length of a call.
+        class Guard
+        {
+        private:
+            const CallDepth &calls;
+
+        public:
+            Guard(const CallDepth &calls, const Token &paren) : calls(calls)
+            {
+                const char *here = static_cast<const char *>(__builtin_frame_address(0));
+
+                if (calls.depth == calls.limit || base - here > room)
+                    calls.overflow(paren);
+
+                calls.depth++;
+            };
+            ~Guard(void) { calls.depth--; };
+            Guard(const Guard &) = delete;
+            Guard &operator=(const Guard &) = delete;
+        };
+    };
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include <interpreter/frame_stack.hpp>
+#include <interpreter/interpreter.hpp>
+#include <algorithm>
+
+using namespace Lox;
+using namespace std;
+
+FrameStack::FrameStack(void)
+    : frames(), stack(new Value[STACK_SIZE]), top(0)
+{
+    frames.reserve(MAX_FRAMES);
+    Heap::instance().addRoots(this);
+}
+
+FrameStack::~FrameStack(void)
+{
+    Heap::instance().removeRoots(this);
+}
+
+Environment *FrameStack::push(Environment *enclosing, const int size) const
+{
+    if (frames.size() == MAX_FRAMES || top + size > STACK_SIZE)
+        return nullptr;
+
+    frames.emplace_back(enclosing, &stack[top]);
+    top += size;
+
+    return &frames.back();
+}
+
+void FrameStack::pop(const int size) const
+{
+    frames.pop_back();
+    top -= size;
+}
+
+void FrameStack::markRoots(Heap &heap) const
+{
+    for (const Environment &frame : frames)
+        frame.trace(heap);
+}
+
+ArgumentStack::ArgumentStack(void)
+    : stack(new Value[STACK_SIZE]), capacity(STACK_SIZE), top(0)
+{
+    Heap::instance().addRoots(this);
+}
+
+ArgumentStack::~ArgumentStack(void)
+{
+    Heap::instance().removeRoots(this);
+}
+
+void ArgumentStack::reserve(size_t calls)
+{
+    if (calls <= capacity / CALL_SIZE)
+        return;
+
+    capacity = calls < MAX_SIZE / CALL_SIZE ? calls * CALL_SIZE : MAX_SIZE;
+    stack.reset(new Value[capacity]);
+}
+
+void ArgumentStack::push(const Token &paren, const Value &value) const
+{
+    if (top == capacity)
+        throw RuntimeError(paren, "Stack overflow.");
+
+    stack[top++] = value;
+}
+
+Arguments ArgumentStack::Scope::replace(size_t mark) const
+{
+    copy(&stack.stack[mark], &stack.stack[stack.top], &stack.stack[base]);
+    stack.top = base + (stack.top - mark);
+
+    return arguments();
+}
+
+void ArgumentStack::markRoots(Heap &heap) const
+{
+    for (size_t i = 0; i < top; i++)
+        heap.mark(stack[i]);
+}
+
+Frame::Frame(const FrameStack &stack, Environment *enclosing, const int size)
+    : stack(stack), size(size), framed(false), environment(stack.push(enclosing, size))
+{
+    framed = environment != nullptr;
+
+    if (!framed)
+        environment = Heap::instance().allocate<Environment>(enclosing, size);
+}
+
+Frame::~Frame(void)
+{
+    environment->close();
+
+    if (framed)
+        stack.pop(size);
+}
@@ -0,0 +1,113 @@
+#ifndef _FRAME_STACK_HPP
+#define _FRAME_STACK_HPP
+
+#include <environment/environment.hpp>
+#include <ast/value.hpp>
+#include <ast/arguments.hpp>
+#include <scanner/token.hpp>
+#include <heap/heap.hpp>
+#include <memory>
+#include <vector>
+
+namespace Lox
+{
+    // Environments of the calls and blocks the tree-walker is running, and
+    // their slots, pushed when a scope starts and popped when it ends
+    // instead of being left to the collector. Closures only hold upvalues,
+    // which are closed before the pop. Both stacks are allocated once and
+    // never move; a scope that doesn't fit gets a heap Environment.
+    class FrameStack : public RootSet
+    {
+    private:
+        static const size_t MAX_FRAMES = 16 * 1024;
+        static const size_t STACK_SIZE = 64 * 1024;
+
+        mutable std::vector<Environment> frames;
+        const std::unique_ptr<Value[]> stack;
+        mutable size_t top;
+
+    public:
+        FrameStack(void);
+        ~FrameStack(void);
+
+        // Returns nullptr when the stack is full.
+        Environment *push(Environment *enclosing, const int size) const;
+        void pop(const int size) const;
+        void markRoots(Heap &heap) const override;
+    };
+
+    // Callees and arguments of the calls being evaluated. Arguments reach
+    // the callee as a span of this stack, and stay rooted with the callee
+    // below them until the call returns.
+    class ArgumentStack : public RootSet
+    {
+    private:
+        static const size_t STACK_SIZE = 64 * 1024;
+        // Room reserved per call for a deeper --max-depth: the callee and
+        // three arguments.
+        static const size_t CALL_SIZE = 4;
+        static const size_t MAX_SIZE = 16 * 1024 * 1024;
+
+        std::unique_ptr<Value[]> stack;
+        size_t capacity;
+        mutable size_t top;
+
+    public:
+        // Everything pushed while a Scope is alive is popped when it ends.
+        class Scope
+        {
+        private:
+            const ArgumentStack &stack;
+            const size_t base;
+            bool kept;
+
+        public:
+            Scope(const ArgumentStack &stack) : stack(stack), base(stack.top), kept(false){};
+            ~Scope(void)
+            {
+                if (!kept)
+                    stack.top = base;
+            };
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+            // What was pushed after the callee.
+            Arguments arguments(void) const { return Arguments(&stack.stack[base + 1], stack.top - base - 1); };
+            // Leaves what was pushed for an enclosing Scope to pop.
+            void keep(void) { kept = true; };
+            // Moves the callee and arguments pushed from mark on down to the
+            // start of the scope, over whatever was there.
+            Arguments replace(size_t mark) const;
+        };
+
+        ArgumentStack(void);
+        ~ArgumentStack(void);
+
+        size_t size(void) const { return top; };
+        // Makes room for calls nested that deep, while nothing is pushed.
+        void reserve(size_t calls);
+
+        void push(const Token &paren, const Value &value) const;
+        void markRoots(Heap &heap) const override;
+    };
+
+    // The Environment of one scope while it executes. Its upvalues are
+    // closed and it is popped on return and on throw alike.
+    class Frame
+    {
+    private:
+        const FrameStack &stack;
+        const int size;
+        bool framed;
+
+    public:
+        Environment *environment;
+
+        Frame(const FrameStack &stack, Environment *enclosing, const int size);
+        ~Frame(void);
+        Frame(const Frame &) = delete;
+        Frame &operator=(const Frame &) = delete;
+    };
+}
+
+#endif
@@ -2,44 +2,52 @@
 #include <ast/callable.hpp>
 #include <ast/primitive.hpp>
 #include <ast/function.hpp>
-#include <ast/return_value.hpp>
 #include <repl/repl.hpp>
-#include <iostream>
+#include <heap/heap.hpp>
+#include <cmath>
 
 using namespace Lox;
 using namespace std;
 
 Interpreter::Interpreter()
-    : environment(make_shared<Environment>()),
-      globals(make_shared<Environment>()),
-      locals(make_shared<unordered_map<shared_ptr<const Expression>, int>>())
+    : globals(Heap::instance().allocate<Environment>()), jit(*this)
+{
+    Heap::instance().addRoots(this);
+    globals->define("clock", Value(ValueType::PRIMITIVE, Heap::instance().allocate<LoxPrimitive>(LoxPrimitiveFn::clock)));
+}
 
+Interpreter::~Interpreter(void)
 {
-    auto clock = make_shared<LoxPrimitive>(LoxPrimitiveFn::clock);
-    globals->define("clock", Value(ValueType::PRIMITIVE, clock));
+    Heap::instance().removeRoots(this);
+}
+
+void Interpreter::setMaxDepth(size_t depth)
+{
+    calls.setLimit(depth);
+    arguments.reserve(depth);
 }
 
 /* 
 PRIVATE 
 */
 
-std::any Interpreter::evaluate(shared_ptr<Environment> env, std::shared_ptr<const Expression> expr) const
+Value Interpreter::evaluate(Environment *env, const Expression *expr) const
 {
     return expr->accept(env, *this);
 }
 
-bool Interpreter::isTruthy(const Value &literal) const
+bool Interpreter::isTruthy(const Value &literal)
 {
     if (literal.type == ValueType::NIL)
         return false;
 
     if (literal.type == ValueType::BOOLEAN)
-        return std::any_cast<bool>(literal.value);
+        return literal.asBoolean();
 
     return true;
 }
 
-bool Interpreter::isEqual(const Value &left, const Value &right) const
+bool Interpreter::isEqual(const Value &left, const Value &right)
 {
     if (left.type == right.type)
     {
@@ -48,11 +56,20 @@ bool Interpreter::isEqual(const Value &left, const Value &right) const
         case ValueType::NIL:
             return true;
         case ValueType::BOOLEAN:
-            return std::any_cast<bool>(left.value) == std::any_cast<bool>(right.value);
+            return left.asBoolean() == right.asBoolean();
         case ValueType::NUMBER:
-            return std::any_cast<double>(left.value) == std::any_cast<double>(right.value);
+            return left.asNumber() == right.asNumber();
         case ValueType::STRING:
-            return std::any_cast<string>(left.value) == std::any_cast<string>(right.value);
+        {
+            // Flat strings are interned, so only ropes need their text compared.
+            const LoxString *l = static_cast<const LoxString *>(left.asObject());
+            const LoxString *r = static_cast<const LoxString *>(right.asObject());
+
+            if (l == r || (l->interned && r->interned) || l->length != r->length)
+                return l == r;
+
+            return l->text() == r->text();
+        }
         default:
             return false;
         }
@@ -62,22 +79,23 @@ bool Interpreter::isEqual(const Value &left, const Value &right) const
 
 std::string Interpreter::stringify(const Value &value)
 {
+    if (value.isObject())
+        return value.asObject()->toString();
+
     switch (value.type)
     {
-    case ValueType::FUNCTION:
-        return std::any_cast<shared_ptr<LoxFunction>>(value.value)->toString();
-    case ValueType::PRIMITIVE:
-        return std::any_cast<shared_ptr<LoxPrimitive>>(value.value)->toString();
     case ValueType::BOOLEAN:
-        return std::any_cast<bool>(value.value)
+        return value.asBoolean()
                    ? (string) "true"
                    : (string) "false";
     case ValueType::NIL:
         return (string) "nil";
     case ValueType::NUMBER:
-        return std::to_string(std::any_cast<double>(value.value));
-    case ValueType::STRING:
-        return std::any_cast<string>(value.value);
+        // A NaN's sign depends on which operand the hardware propagated, and
+        // that differs between the engines, so every NaN prints the same.
+        if (std::isnan(value.asNumber()))
+            return (string) "nan";
+        return std::to_string(value.asNumber());
     default:
         return "?";
     }
@@ -97,15 +115,18 @@ void Interpreter::checkNumberOperands(const Token &token, const Value &left, con
     throw RuntimeError(token, "Operands must be numbers.");
 }
 
-std::any Interpreter::lookUpVariable(std::shared_ptr<Environment> env,
-                                     std::shared_ptr<const Token> name,
-                                     std::shared_ptr<const Expression> expr) const
+Value Interpreter::lookUpVariable(Environment *env,
+                                  const Token *name,
+                                  const Slot &slot,
+                                  const int upvalue) const
 {
-    auto distance = locals->find(expr);
-
-    if (distance != locals->end())
+    if (upvalue >= 0)
     {
-        return env->getAt(distance->second, *name);
+        return env->getUpvalue(upvalue);
+    }
+    else if (!slot.isGlobal())
+    {
+        return env->getAt(slot);
     }
     else
     {
@@ -113,167 +134,250 @@ std::any Interpreter::lookUpVariable(std::shared_ptr<Environment> env,
     }
 }
 
-/* 
-EXPRESSIONS 
-*/
-
-std::any Interpreter::visitAssignExpression(shared_ptr<Environment> env, shared_ptr<const Assign> expr) const
+Value Interpreter::evaluateBinary(Environment *env, const Binary *expr, const Value &left) const
 {
-    std::any value = evaluate(env, expr->value);
+    Heap::Scope scope;
+    Heap::instance().push(left);
+    Value right = evaluate(env, expr->right);
 
-    auto distance = locals->find(expr);
+    if (expr->kind == BinaryKind::UNSEEN)
+        quicken(expr, left, right);
 
-    if (distance != locals->end())
-    {
-        env->assignAt(distance->second, *(expr->name), value);
-    }
-    else
-    {
-        globals->assign(*(expr->name), value);
-    }
-
-    return value;
+    return applyBinary(expr, left, right);
 }
 
-std::any Interpreter::visitBinaryExpression(shared_ptr<Environment> env, shared_ptr<const Binary> expr) const
+void Interpreter::quicken(const Binary *expr, const Value &left, const Value &right) const
 {
-    auto left = std::any_cast<Value>(evaluate(env, expr->left));
-    auto right = std::any_cast<Value>(evaluate(env, expr->right));
+    if (left.isNumber() && right.isNumber())
+        expr->seen |= SEEN_NUMBERS;
+    else if (left.isString() && right.isString())
+        expr->seen |= SEEN_STRINGS;
+    else
+        expr->seen |= SEEN_OTHER;
+
+    if (++expr->hits < QUICKEN_AFTER)
+        return;
+
+    expr->kind = BinaryKind::GENERIC;
+
+    if (expr->seen == SEEN_STRINGS && expr->op->type == TokenType::PLUS)
+        expr->kind = BinaryKind::STRING_CONCAT;
+
+    if (expr->seen != SEEN_NUMBERS)
+        return;
 
     switch (expr->op->type)
     {
     case TokenType::GREATER:
-        checkNumberOperands(*(expr->op), left, right);
-        return Value(
-            ValueType::BOOLEAN,
-            std::any_cast<double>(left.value) > std::any_cast<double>(right.value));
-
+        expr->kind = BinaryKind::NUMBER_GREATER;
+        break;
     case TokenType::GREATER_EQUAL:
-        checkNumberOperands(*(expr->op), left, right);
-        return Value(
-            ValueType::BOOLEAN,
-            std::any_cast<double>(left.value) >= std::any_cast<double>(right.value));
-
+        expr->kind = BinaryKind::NUMBER_GREATER_EQUAL;
+        break;
     case TokenType::LESS:
-        checkNumberOperands(*(expr->op), left, right);
-        return Value(
-            ValueType::BOOLEAN,
-            std::any_cast<double>(left.value) < std::any_cast<double>(right.value));
-
+        expr->kind = BinaryKind::NUMBER_LESS;
+        break;
     case TokenType::LESS_EQUAL:
-        checkNumberOperands(*(expr->op), left, right);
-        return Value(
-            ValueType::BOOLEAN,
-            std::any_cast<double>(left.value) <= std::any_cast<double>(right.value));
-
+        expr->kind = BinaryKind::NUMBER_LESS_EQUAL;
+        break;
     case TokenType::BANG_EQUAL:
-        return Value(ValueType::BOOLEAN, !isEqual(left, right));
-
+        expr->kind = BinaryKind::NUMBER_NOT_EQUAL;
+        break;
     case TokenType::EQUAL_EQUAL:
-        return Value(ValueType::BOOLEAN, isEqual(left, right));
-
+        expr->kind = BinaryKind::NUMBER_EQUAL;
+        break;
     case TokenType::MINUS:
-        checkNumberOperands(*(expr->op), left, right);
-        return Value(
-            ValueType::NUMBER,
-            std::any_cast<double>(left.value) - std::any_cast<double>(right.value));
-
+        expr->kind = BinaryKind::NUMBER_SUBTRACT;
+        break;
     case TokenType::PLUS:
-        if (left.type == ValueType::NUMBER && right.type == ValueType::NUMBER)
-            return Value(
-                ValueType::NUMBER,
-                std::any_cast<double>(left.value) + std::any_cast<double>(right.value));
+        expr->kind = BinaryKind::NUMBER_ADD;
+        break;
+    case TokenType::SLASH:
+        expr->kind = BinaryKind::NUMBER_DIVIDE;
+        break;
+    case TokenType::STAR:
+        expr->kind = BinaryKind::NUMBER_MULTIPLY;
+        break;
+    default:
+        break;
+    }
+}
 
-        if (left.type == ValueType::STRING && right.type == ValueType::STRING)
-            return Value(
-                ValueType::STRING,
-                std::any_cast<string>(left.value) + std::any_cast<string>(right.value));
+void Interpreter::quicken(const Unary *expr, const Value &right) const
+{
+    // Negation is the only operator that depends on its operand's type.
+    if (expr->op->type == TokenType::BANG)
+    {
+        expr->kind = UnaryKind::NOT;
+        return;
+    }
 
-        throw RuntimeError(*(expr->op), "Operands must be two numbers or two strings.");
+    expr->seen |= right.isNumber() ? SEEN_NUMBERS : SEEN_OTHER;
 
-    case TokenType::SLASH:
-        checkNumberOperands(*(expr->op), left, right);
-        return Value(
-            ValueType::NUMBER,
-            std::any_cast<double>(left.value) / std::any_cast<double>(right.value));
+    if (++expr->hits < QUICKEN_AFTER)
+        return;
 
-    case TokenType::STAR:
-        checkNumberOperands(*(expr->op), left, right);
-        return Value(
-            ValueType::NUMBER,
-            std::any_cast<double>(left.value) * std::any_cast<double>(right.value));
+    expr->kind = expr->seen == SEEN_NUMBERS ? UnaryKind::NUMBER_NEGATE : UnaryKind::GENERIC;
+}
 
-    default:
-        return Value(ValueType::NIL, nullptr);
+bool Interpreter::isTailCallable(const Value &callee, size_t count)
+{
+    return callee.type == ValueType::FUNCTION &&
+           static_cast<LoxCallable *>(callee.asObject())->arity() == count;
+}
+
+// The arguments are evaluated in place on the argument stack, and only
+// popped if the call isn't left to the caller.
+Completion Interpreter::tailCall(Environment *env, const Call *expr) const
+{
+    ArgumentStack::Scope scope = ArgumentStack::Scope(arguments);
+    Value callee = evaluate(env, expr->callee);
+
+    arguments.push(*expr->paren, callee);
+
+    for (auto arg : expr->arguments)
+    {
+        Value value = evaluate(env, arg);
+        arguments.push(*expr->paren, value);
     }
+
+    if (isTailCallable(callee, expr->arguments.size()))
+    {
+        scope.keep();
+        return Completion(CompletionType::TAIL_CALL, callee);
+    }
+
+    return Completion(call(expr->paren, callee, scope.arguments()));
 }
 
-std::any Interpreter::visitCallExpression(shared_ptr<Environment> env, shared_ptr<const Call> expr) const
+/* 
+EXPRESSIONS 
+*/
+
+Value Interpreter::visitAssignExpression(Environment *env, const Assign *expr) const
 {
-    auto callee = std::any_cast<Value>(evaluate(env, expr->callee));
-    auto arguments = make_shared<list<Value>>();
+    Value value = evaluate(env, expr->value);
 
-    for (auto arg : *expr->arguments)
-        arguments->push_back(std::any_cast<Value>(evaluate(env, arg)));
+    if (expr->upvalue >= 0)
+    {
+        env->assignUpvalue(expr->upvalue, value);
+    }
+    else if (!expr->slot.isGlobal())
+    {
+        env->assignAt(expr->slot, value);
+    }
+    else
+    {
+        globals->assign(*(expr->name), value);
+    }
 
-    if (callee.type == ValueType::PRIMITIVE)
+    return value;
+}
+
+Value Interpreter::visitBinaryExpression(Environment *env, const Binary *expr) const
+{
+    Value left = evaluate(env, expr->left);
+
+    if (expr->kind == BinaryKind::UNSEEN || expr->kind == BinaryKind::GENERIC)
+        return evaluateBinary(env, expr, left);
+
+    if (expr->kind == BinaryKind::STRING_CONCAT)
     {
-        auto function = std::any_cast<shared_ptr<LoxPrimitive>>(callee.value);
+        if (!left.isString())
+        {
+            expr->kind = BinaryKind::GENERIC;
+            return evaluateBinary(env, expr, left);
+        }
 
-        if (arguments->size() != function->arity())
-            throw RuntimeError(*(expr->paren),
-                               "Expected " + to_string(function->arity()) +
-                                   " arguments but got " + to_string(arguments->size()) +
-                                   ".");
+        Heap::Scope scope;
+        Heap::instance().push(left);
+        Value right = evaluate(env, expr->right);
 
-        return function->call(*this, *arguments);
+        if (!right.isString())
+        {
+            expr->kind = BinaryKind::GENERIC;
+            return applyBinary(expr, left, right);
+        }
+
+        return Heap::instance().concat(left, right);
     }
-    if (callee.type == ValueType::FUNCTION)
+
+    // Every other quickened form works on two numbers, which need no rooting.
+    if (!left.isNumber())
     {
-        auto function = std::any_cast<shared_ptr<LoxFunction>>(callee.value);
+        expr->kind = BinaryKind::GENERIC;
+        return evaluateBinary(env, expr, left);
+    }
 
-        if (arguments->size() != function->arity())
-            throw RuntimeError(*(expr->paren),
-                               "Expected " + to_string(function->arity()) +
-                                   " arguments but got " + to_string(arguments->size()) +
-                                   ".");
+    Value right = evaluate(env, expr->right);
+
+    if (!right.isNumber())
+    {
+        expr->kind = BinaryKind::GENERIC;
+        return applyBinary(expr, left, right);
+    }
 
-        return function->call(*this, *arguments);
+    switch (expr->kind)
+    {
+    case BinaryKind::NUMBER_ADD:
+        return Value(left.asNumber() + right.asNumber());
+    case BinaryKind::NUMBER_SUBTRACT:
+        return Value(left.asNumber() - right.asNumber());
+    case BinaryKind::NUMBER_MULTIPLY:
+        return Value(left.asNumber() * right.asNumber());
+    case BinaryKind::NUMBER_DIVIDE:
+        return Value(left.asNumber() / right.asNumber());
+    case BinaryKind::NUMBER_GREATER:
+        return Value(left.asNumber() > right.asNumber());
+    case BinaryKind::NUMBER_GREATER_EQUAL:
+        return Value(left.asNumber() >= right.asNumber());
+    case BinaryKind::NUMBER_LESS:
+        return Value(left.asNumber() < right.asNumber());
+    case BinaryKind::NUMBER_LESS_EQUAL:
+        return Value(left.asNumber() <= right.asNumber());
+    case BinaryKind::NUMBER_EQUAL:
+        return Value(left.asNumber() == right.asNumber());
+    case BinaryKind::NUMBER_NOT_EQUAL:
+        return Value(left.asNumber() != right.asNumber());
+    default:
+        return applyBinary(expr, left, right);
+    }
+}
+
+Value Interpreter::visitCallExpression(Environment *env, const Call *expr) const
+{
+    ArgumentStack::Scope scope = ArgumentStack::Scope(arguments);
+    Value callee = evaluate(env, expr->callee);
+
+    arguments.push(*expr->paren, callee);
+
+    for (auto arg : expr->arguments)
+    {
+        Value value = evaluate(env, arg);
+        arguments.push(*expr->paren, value);
     }
 
-    throw RuntimeError(*(expr->paren), "Can only call functions and classes.");
+    return call(expr->paren, callee, scope.arguments());
 }
 
-std::any Interpreter::visitGetExpression(shared_ptr<Environment>, shared_ptr<const Get>) const
+Value Interpreter::visitGetExpression(Environment *, const Get *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Interpreter::visitGroupingExpression(shared_ptr<Environment> env, shared_ptr<const Grouping> expr) const
+Value Interpreter::visitGroupingExpression(Environment *env, const Grouping *expr) const
 {
     return evaluate(env, expr->expression);
 }
 
-std::any Interpreter::visitLiteralExpression(shared_ptr<Environment>, shared_ptr<const Literal> expr) const
+Value Interpreter::visitLiteralExpression(Environment *, const Literal *expr) const
 {
-    switch (*(expr->type))
-    {
-    case TokenType::IDENTIFIER:
-        return Value(ValueType::IDENTIFIER, *(expr->value));
-    case TokenType::STRING:
-        return Value(ValueType::STRING, *(expr->value));
-    case TokenType::NUMBER:
-        return Value(ValueType::NUMBER, *(expr->value));
-    case TokenType::BOOLEAN:
-        return Value(ValueType::BOOLEAN, *(expr->value));
-    default:
-        return Value(ValueType::NIL, nullptr);
-    }
+    return expr->value;
 }
 
-std::any Interpreter::visitLogicalExpression(shared_ptr<Environment> env, shared_ptr<const Logical> expr) const
+Value Interpreter::visitLogicalExpression(Environment *env, const Logical *expr) const
 {
-    auto left = std::any_cast<Value>(evaluate(env, expr->left));
+    Value left = evaluate(env, expr->left);
 
     if (expr->op->type == TokenType::OR)
     {
@@ -289,163 +393,301 @@ std::any Interpreter::visitLogicalExpression(shared_ptr<Environment> env, shared
     return evaluate(env, expr->right);
 }
 
-std::any Interpreter::visitSetExpression(shared_ptr<Environment>, shared_ptr<const Set>) const
+Value Interpreter::visitSetExpression(Environment *, const Set *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Interpreter::visitSuperExpression(shared_ptr<Environment>, shared_ptr<const Super>) const
+Value Interpreter::visitSuperExpression(Environment *, const Super *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Interpreter::visitThisExpression(shared_ptr<Environment>, shared_ptr<const This>) const
+Value Interpreter::visitThisExpression(Environment *, const This *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Interpreter::visitUnaryExpression(shared_ptr<Environment> env, shared_ptr<const Unary> expr) const
+Value Interpreter::visitUnaryExpression(Environment *env, const Unary *expr) const
 {
-    auto right = std::any_cast<Value>(evaluate(env, expr->right));
+    Value right = evaluate(env, expr->right);
 
-    switch (expr->op->type)
+    switch (expr->kind)
     {
-    case TokenType::BANG:
-        return Value(ValueType::BOOLEAN, !isTruthy(right));
-    case TokenType::MINUS:
-        checkNumberOperand(*(expr->op), right);
-        return Value(right.type, -std::any_cast<double>(right.value));
+    case UnaryKind::NOT:
+        return Value(!isTruthy(right));
+    case UnaryKind::NUMBER_NEGATE:
+        if (right.isNumber())
+            return Value(-right.asNumber());
+
+        expr->kind = UnaryKind::GENERIC;
+        break;
+    case UnaryKind::UNSEEN:
+        quicken(expr, right);
+        break;
     default:
-        return Value(ValueType::NIL, nullptr);
+        break;
     }
+
+    return applyUnary(expr, right);
 }
 
-std::any Interpreter::visitVariableExpression(shared_ptr<Environment> env, shared_ptr<const Variable> expr) const
+Value Interpreter::visitVariableExpression(Environment *env, const Variable *expr) const
 {
-    return lookUpVariable(env, expr->name, expr);
+    return lookUpVariable(env, expr->name, expr->slot, expr->upvalue);
 }
 
 /* 
 STATEMENTS 
 */
 
-std::any Interpreter::visitBlockStatement(shared_ptr<Environment> env, shared_ptr<const Block> stmt) const
+Completion Interpreter::visitBlockStatement(Environment *env, const Block *stmt) const
 {
-    shared_ptr<Environment> new_env = make_shared<Environment>(env);
-
-    executeBlock(new_env, stmt->statements);
+    Frame frame = Frame(stack, env, stmt->scopeSize);
 
-    return nullptr;
+    return executeBlock(frame.environment, stmt->statements);
 }
 
-std::any Interpreter::visitClassStatement(shared_ptr<Environment>, shared_ptr<const Class>) const
+Completion Interpreter::visitClassStatement(Environment *, const Class *) const
 {
-    return nullptr;
+    return Completion();
 }
 
-std::any Interpreter::visitExpressionStatementStatement(shared_ptr<Environment> env, shared_ptr<const ExpressionStatement> stmt) const
+Completion Interpreter::visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const
 {
     evaluate(env, stmt->expression);
 
-    return nullptr;
+    return Completion();
 }
 
-std::any Interpreter::visitFunctionStatement(shared_ptr<Environment> env, shared_ptr<const Function> stmt) const
+Completion Interpreter::visitFunctionStatement(Environment *env, const Function *stmt) const
 {
-    shared_ptr<LoxFunction> function = make_shared<LoxFunction>(stmt, env);
+    vector<Upvalue *> upvalues = vector<Upvalue *>();
 
-    env->define(stmt->name->lexeme, Value(ValueType::FUNCTION, function));
+    for (const Capture &capture : stmt->upvalues)
+        upvalues.push_back(env->capture(capture));
+
+    Value function = Value(ValueType::FUNCTION, Heap::instance().allocate<LoxFunction>(stmt, move(upvalues)));
+
+    if (env == globals)
+        env->define(stmt->name->symbol, function);
+    else
+        env->define(function);
 
-    return nullptr;
+    return Completion();
 }
 
-std::any Interpreter::visitIfStatement(shared_ptr<Environment> env, shared_ptr<const If> stmt) const
+Completion Interpreter::visitIfStatement(Environment *env, const If *stmt) const
 {
-    auto value = std::any_cast<Value>(evaluate(env, stmt->condition));
+    Value value = evaluate(env, stmt->condition);
 
     if (isTruthy(value))
     {
-        execute(env, stmt->thenBranch);
+        return execute(env, stmt->thenBranch);
     }
     else if (stmt->elseBranch != nullptr)
     {
-        execute(env, stmt->elseBranch);
+        return execute(env, stmt->elseBranch);
     }
 
-    return nullptr;
+    return Completion();
 }
 
-std::any Interpreter::visitPrintStatement(shared_ptr<Environment> env, shared_ptr<const Print> stmt) const
+Completion Interpreter::visitPrintStatement(Environment *env, const Print *stmt) const
 {
-    Value value = std::any_cast<Value>(evaluate(env, stmt->expression));
+    Value value = evaluate(env, stmt->expression);
 
-    cout << stringify(value) << endl;
+    REPL::print(stringify(value));
 
-    return nullptr;
+    return Completion();
 }
 
-std::any Interpreter::visitReturnStatement(shared_ptr<Environment> env, shared_ptr<const Return> stmt) const
+Completion Interpreter::visitReturnStatement(Environment *env, const Return *stmt) const
 {
+    if (stmt->tailCall)
+        return tailCall(env, static_cast<const Call *>(stmt->value));
+
     if (stmt->value != nullptr)
-    {
-        Value value = std::any_cast<Value>(evaluate(env, stmt->value));
-        throw ReturnValue(value);
-    }
+        return Completion(evaluate(env, stmt->value));
 
-    throw ReturnValue(Value(ValueType::NIL, nullptr));
+    return Completion(Value());
 }
 
-std::any Interpreter::visitVarStatement(shared_ptr<Environment> env, shared_ptr<const Var> stmt) const
+Completion Interpreter::visitVarStatement(Environment *env, const Var *stmt) const
 {
-    std::any value;
+    Value value;
 
     if (stmt->initializer != nullptr)
         value = evaluate(env, stmt->initializer);
-    else
-        value = Value(ValueType::NIL, nullptr);
 
-    env->define(stmt->name->lexeme, value);
+    if (env == globals)
+        env->define(stmt->name->symbol, value);
+    else
+        env->define(value);
 
-    return nullptr;
+    return Completion();
 }
 
-std::any Interpreter::visitWhileStatement(shared_ptr<Environment> env, shared_ptr<const While> stmt) const
+Completion Interpreter::visitWhileStatement(Environment *env, const While *stmt) const
 {
-    while (isTruthy(std::any_cast<Value>(evaluate(env, stmt->condition))))
-        execute(env, stmt->body);
+    while (isTruthy(evaluate(env, stmt->condition)))
+    {
+        Completion completion = execute(env, stmt->body);
 
-    return nullptr;
+        if (completion.isReturn())
+            return completion;
+    }
+
+    return Completion();
 }
 
 /* 
 OTHER 
 */
 
-void Interpreter::execute(shared_ptr<Environment> env, shared_ptr<const Statement> stmt) const
+Completion Interpreter::execute(Environment *env, const Statement *stmt) const
 {
-    stmt->accept(env, *this);
+    return stmt->accept(env, *this);
 }
 
-void Interpreter::executeBlock(shared_ptr<Environment> env, shared_ptr<list<shared_ptr<Statement>>> statements) const
+Completion Interpreter::executeBlock(Environment *env, NodeList<const Statement *> statements) const
 {
-    for (auto statement : *statements)
-        execute(env, statement);
-}
+    frames.push_back(env);
 
-void Interpreter::resolve(std::shared_ptr<Environment>, std::shared_ptr<const Expression> expr, int depth) const
-{
-    (*locals)[expr] = depth; // ->insert(make_pair(expr, depth));
+    for (auto statement : statements)
+    {
+        Completion completion = execute(env, statement);
+
+        if (completion.isReturn())
+        {
+            frames.pop_back();
+            return completion;
+        }
+    }
+
+    frames.pop_back();
+    return Completion();
 }
 
-void Interpreter::interpret(vector<shared_ptr<const Statement>> &statements)
+void Interpreter::interpret(vector<const Statement *> &statements)
 {
     try
     {
-        for (shared_ptr<const Statement> stmt : statements)
+        for (const Statement *stmt : statements)
             execute(this->globals, stmt);
     }
     catch (RuntimeError &error)
     {
         REPL::runtimeError(error);
+        frames.clear();
+    }
+}
+
+Value Interpreter::applyBinary(const Binary *expr, const Value &left, const Value &right) const
+{
+    switch (expr->op->type)
+    {
+    case TokenType::GREATER:
+        checkNumberOperands(*(expr->op), left, right);
+        return Value(left.asNumber() > right.asNumber());
+
+    case TokenType::GREATER_EQUAL:
+        checkNumberOperands(*(expr->op), left, right);
+        return Value(left.asNumber() >= right.asNumber());
+
+    case TokenType::LESS:
+        checkNumberOperands(*(expr->op), left, right);
+        return Value(left.asNumber() < right.asNumber());
+
+    case TokenType::LESS_EQUAL:
+        checkNumberOperands(*(expr->op), left, right);
+        return Value(left.asNumber() <= right.asNumber());
+
+    case TokenType::BANG_EQUAL:
+        return Value(!isEqual(left, right));
+
+    case TokenType::EQUAL_EQUAL:
+        return Value(isEqual(left, right));
+
+    case TokenType::MINUS:
+        checkNumberOperands(*(expr->op), left, right);
+        return Value(left.asNumber() - right.asNumber());
+
+    case TokenType::PLUS:
+        if (left.type == ValueType::NUMBER && right.type == ValueType::NUMBER)
+            return Value(left.asNumber() + right.asNumber());
+
+        if (left.type == ValueType::STRING && right.type == ValueType::STRING)
+            return Heap::instance().concat(left, right);
+
+        throw RuntimeError(*(expr->op), "Operands must be two numbers or two strings.");
+
+    case TokenType::SLASH:
+        checkNumberOperands(*(expr->op), left, right);
+        return Value(left.asNumber() / right.asNumber());
+
+    case TokenType::STAR:
+        checkNumberOperands(*(expr->op), left, right);
+        return Value(left.asNumber() * right.asNumber());
+
+    default:
+        return Value();
     }
 }
+
+Value Interpreter::applyUnary(const Unary *expr, const Value &right) const
+{
+    switch (expr->op->type)
+    {
+    case TokenType::BANG:
+        return Value(!isTruthy(right));
+    case TokenType::MINUS:
+        checkNumberOperand(*(expr->op), right);
+        return Value(-right.asNumber());
+    default:
+        return Value();
+    }
+}
+
+Value Interpreter::call(const Token *paren, const Value &callee, Arguments arguments) const
+{
+    if (callee.type == ValueType::PRIMITIVE || callee.type == ValueType::FUNCTION)
+    {
+        auto function = static_cast<LoxCallable *>(callee.asObject());
+
+        if (arguments.size() != function->arity())
+            throw RuntimeError(*paren,
+                               "Expected " + to_string(function->arity()) +
+                                   " arguments but got " + to_string(arguments.size()) +
+                                   ".");
+
+        CallDepth::Guard guard = CallDepth::Guard(calls, *paren);
+        return function->call(*this, arguments);
+    }
+
+    throw RuntimeError(*paren, "Can only call functions and classes.");
+}
+
+// A call in tail position leaves a function and its arguments on the
+// argument stack for the LoxFunction being returned from, which calls it in
+// place of the current one. Anything else is called right away.
+Completion Interpreter::tailCall(const Token *paren, const Value &callee, Arguments arguments) const
+{
+    if (!isTailCallable(callee, arguments.size()))
+        return Completion(call(paren, callee, arguments));
+
+    this->arguments.push(*paren, callee);
+
+    for (const Value &argument : arguments)
+        this->arguments.push(*paren, argument);
+
+    return Completion(CompletionType::TAIL_CALL, callee);
+}
+
+void Interpreter::markRoots(Heap &heap) const
+{
+    heap.mark(globals);
+
+    for (Environment *frame : frames)
+        heap.mark(frame);
+}
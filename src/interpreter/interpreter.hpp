@@ -5,11 +5,16 @@
 #include <ast/statement.hpp>
 #include <environment/environment.hpp>
 #include <ast/value.hpp>
+#include <ast/arguments.hpp>
+#include <ast/completion.hpp>
+#include <heap/heap.hpp>
+#include <jit/jit.hpp>
+#include <interpreter/frame_stack.hpp>
+#include <interpreter/call_depth.hpp>
 #include <exception>
 #include <vector>
 #include <string>
 #include <memory>
-#include <unordered_map>
 #include <any>
 
 namespace Lox
@@ -25,53 +30,72 @@ namespace Lox
         }
     };
 
-    class Interpreter : public ExpressionVisitor, public StatementVisitor
+    class Interpreter : public ExpressionVisitor,
+                        public StatementVisitor,
+                        public RootSet
     {
     private:
-        std::any evaluate(std::shared_ptr<Environment> env, std::shared_ptr<const Expression> expr) const;
-        bool isTruthy(const Value &literal) const;
-        bool isEqual(const Value &left, const Value &right) const;
-        static std::string stringify(const Value &value);
+        // Environments of the blocks and calls currently executing.
+        mutable std::vector<Environment *> frames;
+
+        Value evaluate(Environment *env, const Expression *expr) const;
         void checkNumberOperand(const Token &token, const Value &right) const;
         void checkNumberOperands(const Token &token, const Value &left, const Value &right) const;
-        std::any lookUpVariable(std::shared_ptr<Environment> env,
-                                std::shared_ptr<const Token> name,
-                                std::shared_ptr<const Expression> expr) const;
+        Value lookUpVariable(Environment *env,
+                             const Token *name,
+                             const Slot &slot,
+                             const int upvalue) const;
+        Value evaluateBinary(Environment *env, const Binary *expr, const Value &left) const;
+        void quicken(const Binary *expr, const Value &left, const Value &right) const;
+        void quicken(const Unary *expr, const Value &right) const;
+        Completion tailCall(Environment *env, const Call *expr) const;
 
     public:
-        const std::shared_ptr<Environment> environment;
-        const std::shared_ptr<Environment> globals;
-        const std::shared_ptr<std::unordered_map<std::shared_ptr<const Expression>, int>> locals;
+        Environment *const globals;
+        FrameStack stack;
+        ArgumentStack arguments;
+        CallDepth calls;
+        Jit jit;
 
         Interpreter(void);
+        ~Interpreter(void);
+        void setMaxDepth(size_t depth);
+        static bool isTruthy(const Value &literal);
+        static bool isEqual(const Value &left, const Value &right);
+        static std::string stringify(const Value &value);
+        static bool isTailCallable(const Value &callee, size_t count);
         // EXPRESSIONS
-        std::any visitAssignExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Assign> expr) const override;
-        std::any visitBinaryExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Binary> expr) const override;
-        std::any visitCallExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Call> expr) const override;
-        std::any visitGetExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Get> expr) const override;
-        std::any visitGroupingExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Grouping> expr) const override;
-        std::any visitLiteralExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Literal> expr) const override;
-        std::any visitLogicalExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Logical> expr) const override;
-        std::any visitSetExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Set> expr) const override;
-        std::any visitSuperExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Super> expr) const override;
-        std::any visitThisExpression(std::shared_ptr<Environment> env, std::shared_ptr<const This> expr) const override;
-        std::any visitUnaryExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Unary> expr) const override;
-        std::any visitVariableExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Variable> expr) const override;
+        Value visitAssignExpression(Environment *env, const Assign *expr) const override;
+        Value visitBinaryExpression(Environment *env, const Binary *expr) const override;
+        Value visitCallExpression(Environment *env, const Call *expr) const override;
+        Value visitGetExpression(Environment *env, const Get *expr) const override;
+        Value visitGroupingExpression(Environment *env, const Grouping *expr) const override;
+        Value visitLiteralExpression(Environment *env, const Literal *expr) const override;
+        Value visitLogicalExpression(Environment *env, const Logical *expr) const override;
+        Value visitSetExpression(Environment *env, const Set *expr) const override;
+        Value visitSuperExpression(Environment *env, const Super *expr) const override;
+        Value visitThisExpression(Environment *env, const This *expr) const override;
+        Value visitUnaryExpression(Environment *env, const Unary *expr) const override;
+        Value visitVariableExpression(Environment *env, const Variable *expr) const override;
         // STATEMENTS
-        std::any visitBlockStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Block> stmt) const override;
-        std::any visitClassStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Class> stmt) const override;
-        std::any visitExpressionStatementStatement(std::shared_ptr<Environment> env, std::shared_ptr<const ExpressionStatement> stmt) const override;
-        std::any visitFunctionStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Function> stmt) const override;
-        std::any visitIfStatement(std::shared_ptr<Environment> env, std::shared_ptr<const If> stmt) const override;
-        std::any visitPrintStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Print> stmt) const override;
-        std::any visitReturnStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Return> stmt) const override;
-        std::any visitVarStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Var> stmt) const override;
-        std::any visitWhileStatement(std::shared_ptr<Environment> env, std::shared_ptr<const While> stmt) const override;
+        Completion visitBlockStatement(Environment *env, const Block *stmt) const override;
+        Completion visitClassStatement(Environment *env, const Class *stmt) const override;
+        Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const override;
+        Completion visitFunctionStatement(Environment *env, const Function *stmt) const override;
+        Completion visitIfStatement(Environment *env, const If *stmt) const override;
+        Completion visitPrintStatement(Environment *env, const Print *stmt) const override;
+        Completion visitReturnStatement(Environment *env, const Return *stmt) const override;
+        Completion visitVarStatement(Environment *env, const Var *stmt) const override;
+        Completion visitWhileStatement(Environment *env, const While *stmt) const override;
         // OTHER
-        void executeBlock(std::shared_ptr<Environment> env, std::shared_ptr<std::list<std::shared_ptr<Statement>>> statements) const;
-        void execute(std::shared_ptr<Environment> env, std::shared_ptr<const Statement> stmt) const;
-        void resolve(std::shared_ptr<Environment> env, std::shared_ptr<const Expression> expr, int depth) const;
-        void interpret(std::vector<std::shared_ptr<const Statement>> &statements);
+        Value applyBinary(const Binary *expr, const Value &left, const Value &right) const;
+        Value applyUnary(const Unary *expr, const Value &right) const;
+        Value call(const Token *paren, const Value &callee, Arguments arguments) const;
+        Completion tailCall(const Token *paren, const Value &callee, Arguments arguments) const;
+        Completion executeBlock(Environment *env, NodeList<const Statement *> statements) const;
+        Completion execute(Environment *env, const Statement *stmt) const;
+        void interpret(std::vector<const Statement *> &statements);
+        void markRoots(Heap &heap) const override;
     };
 }
 
@@ -0,0 +1,225 @@
+#include <jit/assembler.hpp>
+#include <cstring>
+
+using namespace Lox;
+using namespace std;
+
+static_assert(sizeof(ValueType) == 4, "Value types are compared as dwords");
+static_assert(offsetof(Value, as) == 8, "Value payloads are expected after the type");
+
+/* 
+PRIVATE 
+*/
+
+void Assembler::byte(uint8_t value)
+{
+    bytes.push_back(value);
+}
+
+void Assembler::dword(uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        byte(value >> (8 * i));
+}
+
+void Assembler::qword(uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+        byte(value >> (8 * i));
+}
+
+// ModRM and displacement for [rbx + disp32], with reg in the middle field.
+void Assembler::slot(uint8_t reg, int slot, bool payload)
+{
+    byte(0x83 | (reg << 3));
+    dword(slot * sizeof(Value) + (payload ? offsetof(Value, as) : 0));
+}
+
+size_t Assembler::displacement(void)
+{
+    dword(0);
+    return here() - 4;
+}
+
+/* 
+PUBLIC 
+*/
+
+void Assembler::prologue(void)
+{
+    byte(0x55);                         // push rbp
+    byte(0x48), byte(0x89), byte(0xE5); // mov rbp, rsp
+    byte(0x53);                         // push rbx
+    byte(0x41), byte(0x54);             // push r12
+    byte(0x48), byte(0x89), byte(0xF3); // mov rbx, rsi
+    byte(0x49), byte(0x89), byte(0xFC); // mov r12, rdi
+}
+
+void Assembler::epilogue(int status)
+{
+    byte(0xB8), dword(status); // mov eax, status
+    byte(0x41), byte(0x5C);    // pop r12
+    byte(0x5B);                // pop rbx
+    byte(0x5D);                // pop rbp
+    byte(0xC3);                // ret
+}
+
+void Assembler::storeType(int to, ValueType type)
+{
+    byte(0xC7), slot(0, to, false), dword(static_cast<uint32_t>(type));
+}
+
+void Assembler::storeNumber(int to, double number)
+{
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+
+    byte(0x48), byte(0xB8), qword(bits);       // mov rax, bits
+    byte(0x48), byte(0x89), slot(0, to, true); // mov [to], rax
+    storeType(to, ValueType::NUMBER);
+}
+
+void Assembler::storeBoolean(int to, bool boolean)
+{
+    byte(0xC6), slot(0, to, true), byte(boolean);
+    storeType(to, ValueType::BOOLEAN);
+}
+
+void Assembler::storeObject(int to, ValueType type, const Object *object)
+{
+    byte(0x48), byte(0xB8), qword(reinterpret_cast<uint64_t>(object)); // mov rax, object
+    byte(0x48), byte(0x89), slot(0, to, true);                          // mov [to], rax
+    storeType(to, type);
+}
+
+void Assembler::copy(int to, int from)
+{
+    byte(0x0F), byte(0x10), slot(0, from, false); // movups xmm0, [from]
+    byte(0x0F), byte(0x11), slot(0, to, false);   // movups [to], xmm0
+}
+
+void Assembler::arithmetic(Arithmetic op, int to, int left, int right)
+{
+    byte(0xF2), byte(0x0F), byte(0x10), slot(0, left, true); // movsd xmm0, [left]
+    byte(0xF2), byte(0x0F), byte(op), slot(0, right, true);  // op xmm0, [right]
+    byte(0xF2), byte(0x0F), byte(0x11), slot(0, to, true);   // movsd [to], xmm0
+    storeType(to, ValueType::NUMBER);
+}
+
+void Assembler::compare(Comparison op, int to, int left, int right)
+{
+    // ucomisd flags an unordered compare as both below and equal, so every
+    // test is written as "above" or combined with the parity flag to keep
+    // NaN comparisons false, as they are in C++.
+    if (op == LESS || op == LESS_EQUAL)
+        swap(left, right);
+
+    byte(0xF2), byte(0x0F), byte(0x10), slot(0, left, true);  // movsd xmm0, [left]
+    byte(0x66), byte(0x0F), byte(0x2E), slot(0, right, true); // ucomisd xmm0, [right]
+
+    switch (op)
+    {
+    case GREATER:
+    case LESS:
+        byte(0x0F), byte(0x97), byte(0xC0); // seta al
+        break;
+    case GREATER_EQUAL:
+    case LESS_EQUAL:
+        byte(0x0F), byte(0x93), byte(0xC0); // setae al
+        break;
+    case EQUAL:
+        byte(0x0F), byte(0x94), byte(0xC0); // sete al
+        byte(0x0F), byte(0x9B), byte(0xC1); // setnp cl
+        byte(0x20), byte(0xC8);             // and al, cl
+        break;
+    case NOT_EQUAL:
+        byte(0x0F), byte(0x95), byte(0xC0); // setne al
+        byte(0x0F), byte(0x9A), byte(0xC1); // setp cl
+        byte(0x08), byte(0xC8);             // or al, cl
+        break;
+    }
+
+    storeTruth(to);
+}
+
+void Assembler::negate(int to, int from)
+{
+    byte(0x48), byte(0x8B), slot(0, from, true);                // mov rax, [from]
+    byte(0x48), byte(0x0F), byte(0xBA), byte(0xF8), byte(0x3F); // btc rax, 63
+    byte(0x48), byte(0x89), slot(0, to, true);                  // mov [to], rax
+    storeType(to, ValueType::NUMBER);
+}
+
+void Assembler::truthy(int from)
+{
+    byte(0x31), byte(0xC0);                                                 // xor eax, eax
+    byte(0x8B), slot(1, from, false);                                       // mov ecx, [from]
+    byte(0x83), byte(0xF9), byte(static_cast<uint8_t>(ValueType::NIL));     // cmp ecx, NIL
+    byte(0x74), byte(0x0D);                                                 // je done
+    byte(0xB0), byte(0x01);                                                 // mov al, 1
+    byte(0x83), byte(0xF9), byte(static_cast<uint8_t>(ValueType::BOOLEAN)); // cmp ecx, BOOLEAN
+    byte(0x75), byte(0x06);                                                 // jne done
+    byte(0x8A), slot(0, from, true);                                        // mov al, [from]
+}
+
+void Assembler::invertTruth(void)
+{
+    byte(0x34), byte(0x01); // xor al, 1
+}
+
+void Assembler::storeTruth(int to)
+{
+    byte(0x88), slot(0, to, true); // mov [to], al
+    storeType(to, ValueType::BOOLEAN);
+}
+
+size_t Assembler::jumpIfNotNumber(int from)
+{
+    byte(0x83), slot(7, from, false), byte(static_cast<uint8_t>(ValueType::NUMBER)); // cmp dword [from], NUMBER
+    byte(0x0F), byte(0x85);                                                          // jne
+    return displacement();
+}
+
+size_t Assembler::jumpIfFalse(void)
+{
+    byte(0x84), byte(0xC0); // test al, al
+    byte(0x0F), byte(0x84); // jz
+    return displacement();
+}
+
+size_t Assembler::jumpIfTrue(void)
+{
+    byte(0x84), byte(0xC0); // test al, al
+    byte(0x0F), byte(0x85); // jnz
+    return displacement();
+}
+
+size_t Assembler::jump(void)
+{
+    byte(0xE9);
+    return displacement();
+}
+
+void Assembler::jumpBack(size_t target)
+{
+    byte(0xE9);
+    dword(static_cast<uint32_t>(target - (here() + 4)));
+}
+
+void Assembler::bind(size_t jump)
+{
+    uint32_t offset = static_cast<uint32_t>(here() - (jump + 4));
+    memcpy(&bytes[jump], &offset, sizeof(offset));
+}
+
+size_t Assembler::callRuntime(const void *function, int to, const void *node)
+{
+    byte(0x4C), byte(0x89), byte(0xE7);                                  // mov rdi, r12
+    byte(0x48), byte(0x8D), slot(6, to, false);                          // lea rsi, [to]
+    byte(0x48), byte(0xBA), qword(reinterpret_cast<uint64_t>(node));     // mov rdx, node
+    byte(0x48), byte(0xB8), qword(reinterpret_cast<uint64_t>(function)); // mov rax, function
+    byte(0xFF), byte(0xD0);                                              // call rax
+    byte(0x85), byte(0xC0);                                              // test eax, eax
+    byte(0x0F), byte(0x85);                                              // jnz
+    return displacement();
+}
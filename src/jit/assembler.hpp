@@ -0,0 +1,78 @@
+#ifndef _ASSEMBLER_HPP
+#define _ASSEMBLER_HPP
+
+#include <ast/value.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Lox
+{
+    // Emits the few x86-64 instruction templates the JIT is built from.
+    // Values live in a frame addressed by rbx, slot by slot, and r12 holds
+    // the context passed to runtime calls. Jumps return the position of
+    // their displacement, which bind() later points at the current end.
+    class Assembler
+    {
+    private:
+        std::vector<uint8_t> bytes;
+
+        void byte(uint8_t value);
+        void dword(uint32_t value);
+        void qword(uint64_t value);
+        void slot(uint8_t reg, int slot, bool payload);
+        size_t displacement(void);
+
+    public:
+        enum Arithmetic
+        {
+            ADD = 0x58,
+            MULTIPLY = 0x59,
+            SUBTRACT = 0x5C,
+            DIVIDE = 0x5E
+        };
+
+        enum Comparison
+        {
+            GREATER,
+            GREATER_EQUAL,
+            LESS,
+            LESS_EQUAL,
+            EQUAL,
+            NOT_EQUAL
+        };
+
+        const std::vector<uint8_t> &code(void) const { return bytes; };
+        size_t here(void) const { return bytes.size(); };
+
+        void prologue(void);
+        void epilogue(int status);
+
+        void storeType(int to, ValueType type);
+        void storeNumber(int to, double number);
+        void storeBoolean(int to, bool boolean);
+        void storeObject(int to, ValueType type, const Object *object);
+        void copy(int to, int from);
+        void arithmetic(Arithmetic op, int to, int left, int right);
+        void compare(Comparison op, int to, int left, int right);
+        void negate(int to, int from);
+
+        // Leaves the truthiness of a slot in al.
+        void truthy(int from);
+        void invertTruth(void);
+        void storeTruth(int to);
+
+        size_t jumpIfNotNumber(int from);
+        size_t jumpIfFalse(void);
+        size_t jumpIfTrue(void);
+        size_t jump(void);
+        void jumpBack(size_t target);
+        void bind(size_t jump);
+
+        // Calls int function(context, &frame[slot], node), and returns the
+        // jump taken when it fails.
+        size_t callRuntime(const void *function, int slot, const void *node);
+    };
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include <jit/jit.hpp>
+#include <jit/native_compiler.hpp>
+
+using namespace Lox;
+using namespace std;
+
+Jit::Jit(const Interpreter &interpreter)
+    : interpreter(interpreter), enabled(true), stack(new Value[STACK_SIZE]), top(0)
+{
+    Heap::instance().addRoots(this);
+}
+
+Jit::~Jit(void)
+{
+    Heap::instance().removeRoots(this);
+}
+
+/* 
+PRIVATE 
+*/
+
+NativeCode *Jit::compile(const Function *function) const
+{
+#if defined(__x86_64__)
+    unique_ptr<NativeCode> native = make_unique<NativeCode>();
+    NativeCompiler compiler = NativeCompiler(*native);
+
+    if (!compiler.compile(function))
+        return nullptr;
+
+    code.push_back(std::move(native));
+    return code.back().get();
+#else
+    (void)function;
+    return nullptr;
+#endif
+}
+
+/* 
+PUBLIC 
+*/
+
+void Jit::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+}
+
+bool Jit::call(const Function *function,
+               Upvalue *const *upvalues,
+               Arguments args,
+               Completion &completion) const
+{
+    if (!enabled)
+        return false;
+
+    if (function->native == nullptr)
+    {
+        if (function->calls < 0 || ++function->calls < HOT_CALLS)
+            return false;
+
+        function->native = compile(function);
+
+        if (function->native == nullptr)
+        {
+            // Never try again.
+            function->calls = -1;
+            return false;
+        }
+    }
+
+    const NativeCode &native = *function->native;
+    size_t base = top;
+
+    if (base + native.frameSize > STACK_SIZE)
+        return false;
+
+    Value *frame = &stack[base];
+    int slot = 1;
+
+    for (int i = 0; i < native.frameSize; i++)
+        frame[i] = Value();
+
+    for (auto &arg : args)
+        frame[slot++] = arg;
+
+    top = base + native.frameSize;
+
+    NativeContext context = NativeContext{interpreter, upvalues, nullptr, false};
+    int status = native.entry(&context, frame);
+
+    completion = Completion(context.tailCall ? CompletionType::TAIL_CALL : CompletionType::RETURN, frame[0]);
+    top = base;
+
+    if (status != 0)
+        rethrow_exception(context.error);
+
+    return true;
+}
+
+void Jit::markRoots(Heap &heap) const
+{
+    for (size_t i = 0; i < top; i++)
+        heap.mark(stack[i]);
+}
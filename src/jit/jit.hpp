@@ -0,0 +1,63 @@
+#ifndef _JIT_HPP
+#define _JIT_HPP
+
+#include <ast/statement.hpp>
+#include <ast/completion.hpp>
+#include <ast/value.hpp>
+#include <ast/arguments.hpp>
+#include <environment/environment.hpp>
+#include <heap/heap.hpp>
+#include <jit/native_code.hpp>
+#include <exception>
+#include <memory>
+#include <vector>
+
+namespace Lox
+{
+    class Interpreter;
+
+    struct NativeContext
+    {
+        const Interpreter &interpreter;
+        Upvalue *const *upvalues;
+        std::exception_ptr error;
+        // Set when the result is a function to tail call.
+        bool tailCall;
+    };
+
+    // Compiles functions the tree-walker calls often into x86-64 machine
+    // code and runs them in its place. Functions it can't compile, calls
+    // that don't fit on its stack and other platforms keep being
+    // interpreted.
+    class Jit : public RootSet
+    {
+    private:
+        static const int HOT_CALLS = 2;
+        static const size_t STACK_SIZE = 64 * 1024;
+
+        const Interpreter &interpreter;
+        bool enabled;
+        mutable std::vector<std::unique_ptr<NativeCode>> code;
+        // Frames of the machine code currently running, never reallocated
+        // since the code holds pointers into it.
+        const std::unique_ptr<Value[]> stack;
+        mutable size_t top;
+
+        NativeCode *compile(const Function *function) const;
+
+    public:
+        Jit(const Interpreter &interpreter);
+        ~Jit(void);
+
+        void setEnabled(bool enabled);
+        // Runs the function natively if it is hot enough, returning false
+        // when the caller should interpret it instead.
+        bool call(const Function *function,
+                  Upvalue *const *upvalues,
+                  Arguments args,
+                  Completion &completion) const;
+        void markRoots(Heap &heap) const override;
+    };
+}
+
+#endif
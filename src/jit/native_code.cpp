@@ -0,0 +1,37 @@
+#include <jit/native_code.hpp>
+#include <sys/mman.h>
+#include <cstring>
+
+using namespace Lox;
+using namespace std;
+
+NativeCode::NativeCode(void) : memory(nullptr), length(0), entry(nullptr), frameSize(0) {}
+
+NativeCode::~NativeCode(void)
+{
+    if (memory != nullptr)
+        munmap(memory, length);
+}
+
+bool NativeCode::load(const vector<uint8_t> &code)
+{
+    // The code is written while the pages are writable, then they are made
+    // executable, so no page is ever both.
+    void *pages = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (pages == MAP_FAILED)
+        return false;
+
+    memcpy(pages, code.data(), code.size());
+
+    if (mprotect(pages, code.size(), PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(pages, code.size());
+        return false;
+    }
+
+    memory = pages;
+    length = code.size();
+    entry = reinterpret_cast<Entry>(pages);
+    return true;
+}
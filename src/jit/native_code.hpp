@@ -0,0 +1,53 @@
+#ifndef _NATIVE_CODE_HPP
+#define _NATIVE_CODE_HPP
+
+#include <environment/environment.hpp>
+#include <scanner/token.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace Lox
+{
+    class Value;
+
+    // Passed to every call the machine code makes into the runtime.
+    struct NativeContext;
+
+    // A variable the machine code can't keep in its frame: one of the
+    // function's upvalues, or a global when upvalue is negative.
+    struct NativeAccess
+    {
+        const Token *name;
+        int upvalue;
+    };
+
+    // Machine code for one function, mapped into executable memory. The code
+    // takes the context and a frame of Values: the result, then the
+    // parameters, then locals and temporaries. It returns zero, or non-zero
+    // when a runtime call failed and the context holds the error.
+    class NativeCode
+    {
+    private:
+        void *memory;
+        size_t length;
+
+    public:
+        typedef int (*Entry)(NativeContext *context, Value *frame);
+
+        Entry entry;
+        int frameSize;
+        // Referenced from the code, so they need stable addresses.
+        std::deque<NativeAccess> accesses;
+
+        NativeCode(void);
+        ~NativeCode(void);
+        NativeCode(const NativeCode &) = delete;
+        NativeCode &operator=(const NativeCode &) = delete;
+
+        bool load(const std::vector<uint8_t> &code);
+    };
+}
+
+#endif
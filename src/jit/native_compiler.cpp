@@ -0,0 +1,530 @@
+#include <jit/native_compiler.hpp>
+#include <jit/jit.hpp>
+#include <interpreter/interpreter.hpp>
+#include <repl/repl.hpp>
+#include <algorithm>
+
+using namespace Lox;
+using namespace std;
+
+/* 
+RUNTIME 
+*/
+
+// Runtime calls catch everything, since an exception can't unwind through
+// the machine code. The code returns instead and the Jit rethrows.
+template <typename F>
+static int guard(NativeContext *context, F body)
+{
+    try
+    {
+        body();
+        return 0;
+    }
+    catch (...)
+    {
+        context->error = current_exception();
+        return 1;
+    }
+}
+
+static int runtimeGet(NativeContext *context, Value *slot, const void *node)
+{
+    auto access = static_cast<const NativeAccess *>(node);
+
+    return guard(context, [&]()
+                 {
+                     if (access->upvalue < 0)
+                         *slot = context->interpreter.globals->get(*(access->name));
+                     else
+                         *slot = *context->upvalues[access->upvalue]->location; });
+}
+
+static int runtimeAssign(NativeContext *context, Value *slot, const void *node)
+{
+    auto access = static_cast<const NativeAccess *>(node);
+
+    return guard(context, [&]()
+                 {
+                     if (access->upvalue < 0)
+                         context->interpreter.globals->assign(*(access->name), *slot);
+                     else
+                         *context->upvalues[access->upvalue]->location = *slot; });
+}
+
+static int runtimeBinary(NativeContext *context, Value *slot, const void *node)
+{
+    auto expr = static_cast<const Binary *>(node);
+
+    return guard(context, [&]()
+                 { *slot = context->interpreter.applyBinary(expr, slot[0], slot[1]); });
+}
+
+static int runtimeUnary(NativeContext *context, Value *slot, const void *node)
+{
+    auto expr = static_cast<const Unary *>(node);
+
+    return guard(context, [&]()
+                 { *slot = context->interpreter.applyUnary(expr, slot[0]); });
+}
+
+static int runtimeCall(NativeContext *context, Value *slot, const void *node)
+{
+    auto expr = static_cast<const Call *>(node);
+
+    return guard(context, [&]()
+                 {
+                     Arguments arguments = Arguments(slot + 1, expr->arguments.size());
+                     *slot = context->interpreter.call(expr->paren, slot[0], arguments); });
+}
+
+static int runtimeTailCall(NativeContext *context, Value *slot, const void *node)
+{
+    auto expr = static_cast<const Call *>(node);
+
+    return guard(context, [&]()
+                 {
+                     Arguments arguments = Arguments(slot + 1, expr->arguments.size());
+                     Completion completion = context->interpreter.tailCall(expr->paren, slot[0], arguments);
+                     *slot = completion.value;
+                     context->tailCall = completion.isTailCall(); });
+}
+
+static int runtimePrint(NativeContext *context, Value *slot, const void *)
+{
+    return guard(context, [&]()
+                 { REPL::print(Interpreter::stringify(*slot)); });
+}
+
+NativeCompiler::NativeCompiler(NativeCode &native)
+    : native(native), target(0), top(0), supported(true)
+{
+}
+
+/* 
+PRIVATE 
+*/
+
+int NativeCompiler::allocate(void) const
+{
+    native.frameSize = max(native.frameSize, top + 1);
+    return top++;
+}
+
+// The frame slot of a local declared in this function, or -1.
+int NativeCompiler::local(const Slot &slot) const
+{
+    if (slot.isGlobal() || slot.depth >= (int)scopes.size())
+        return -1;
+
+    const vector<int> &scope = scopes[scopes.size() - 1 - slot.depth];
+
+    if (slot.index >= (int)scope.size())
+    {
+        supported = false;
+        return 0;
+    }
+
+    return scope[slot.index];
+}
+
+const NativeAccess *NativeCompiler::access(const Token *name, const int upvalue) const
+{
+    native.accesses.push_back(NativeAccess{name, upvalue});
+    return &native.accesses.back();
+}
+
+// Evaluates the callee and arguments into consecutive slots, returning the
+// callee's.
+int NativeCompiler::operands(const Call *expr) const
+{
+    int callee = allocate();
+
+    compile(expr->callee, callee);
+
+    for (auto arg : expr->arguments)
+        compile(arg, allocate());
+
+    return callee;
+}
+
+void NativeCompiler::call(const void *function, int slot, const void *node) const
+{
+    failures.push_back(assembler.callRuntime(function, slot, node));
+}
+
+void NativeCompiler::compile(const Expression *expr, int to) const
+{
+    int saved = top;
+
+    target = to;
+    expr->accept(nullptr, *this);
+    top = saved;
+}
+
+void NativeCompiler::compile(const Statement *stmt) const
+{
+    stmt->accept(nullptr, *this);
+}
+
+void NativeCompiler::compile(NodeList<const Statement *> statements) const
+{
+    for (auto stmt : statements)
+        compile(stmt);
+}
+
+/* 
+EXPRESSIONS 
+*/
+
+Value NativeCompiler::visitAssignExpression(Environment *, const Assign *expr) const
+{
+    int to = target;
+    int value = allocate();
+    int slot = local(expr->slot);
+
+    compile(expr->value, value);
+
+    if (slot >= 0)
+        assembler.copy(slot, value);
+    else
+        call(reinterpret_cast<const void *>(runtimeAssign), value, access(expr->name, expr->upvalue));
+
+    assembler.copy(to, value);
+    return Value();
+}
+
+Value NativeCompiler::visitBinaryExpression(Environment *, const Binary *expr) const
+{
+    int to = target;
+    int left = allocate();
+    compile(expr->left, left);
+    int right = allocate();
+    compile(expr->right, right);
+
+    size_t leftType = assembler.jumpIfNotNumber(left);
+    size_t rightType = assembler.jumpIfNotNumber(right);
+
+    switch (expr->op->type)
+    {
+    case TokenType::PLUS:
+        assembler.arithmetic(Assembler::ADD, to, left, right);
+        break;
+    case TokenType::MINUS:
+        assembler.arithmetic(Assembler::SUBTRACT, to, left, right);
+        break;
+    case TokenType::STAR:
+        assembler.arithmetic(Assembler::MULTIPLY, to, left, right);
+        break;
+    case TokenType::SLASH:
+        assembler.arithmetic(Assembler::DIVIDE, to, left, right);
+        break;
+    case TokenType::GREATER:
+        assembler.compare(Assembler::GREATER, to, left, right);
+        break;
+    case TokenType::GREATER_EQUAL:
+        assembler.compare(Assembler::GREATER_EQUAL, to, left, right);
+        break;
+    case TokenType::LESS:
+        assembler.compare(Assembler::LESS, to, left, right);
+        break;
+    case TokenType::LESS_EQUAL:
+        assembler.compare(Assembler::LESS_EQUAL, to, left, right);
+        break;
+    case TokenType::EQUAL_EQUAL:
+        assembler.compare(Assembler::EQUAL, to, left, right);
+        break;
+    case TokenType::BANG_EQUAL:
+        assembler.compare(Assembler::NOT_EQUAL, to, left, right);
+        break;
+    default:
+        supported = false;
+        break;
+    }
+
+    size_t done = assembler.jump();
+
+    assembler.bind(leftType);
+    assembler.bind(rightType);
+    call(reinterpret_cast<const void *>(runtimeBinary), left, expr);
+    assembler.copy(to, left);
+    assembler.bind(done);
+    return Value();
+}
+
+Value NativeCompiler::visitCallExpression(Environment *, const Call *expr) const
+{
+    int to = target;
+    int callee = operands(expr);
+
+    call(reinterpret_cast<const void *>(runtimeCall), callee, expr);
+    assembler.copy(to, callee);
+    return Value();
+}
+
+Value NativeCompiler::visitGetExpression(Environment *, const Get *) const
+{
+    supported = false;
+    return Value();
+}
+
+Value NativeCompiler::visitGroupingExpression(Environment *, const Grouping *expr) const
+{
+    compile(expr->expression, target);
+    return Value();
+}
+
+Value NativeCompiler::visitLiteralExpression(Environment *, const Literal *expr) const
+{
+    switch (expr->value.type)
+    {
+    case ValueType::NUMBER:
+        assembler.storeNumber(target, expr->value.asNumber());
+        break;
+    case ValueType::BOOLEAN:
+        assembler.storeBoolean(target, expr->value.asBoolean());
+        break;
+    case ValueType::STRING:
+        // Literal strings are never collected, so the code can embed them.
+        assembler.storeObject(target, ValueType::STRING, expr->value.asObject());
+        break;
+    default:
+        assembler.storeType(target, ValueType::NIL);
+        break;
+    }
+
+    return Value();
+}
+
+Value NativeCompiler::visitLogicalExpression(Environment *, const Logical *expr) const
+{
+    int to = target;
+
+    compile(expr->left, to);
+    assembler.truthy(to);
+
+    size_t skip = expr->op->type == TokenType::OR ? assembler.jumpIfTrue() : assembler.jumpIfFalse();
+
+    compile(expr->right, to);
+    assembler.bind(skip);
+    return Value();
+}
+
+Value NativeCompiler::visitSetExpression(Environment *, const Set *) const
+{
+    supported = false;
+    return Value();
+}
+
+Value NativeCompiler::visitSuperExpression(Environment *, const Super *) const
+{
+    supported = false;
+    return Value();
+}
+
+Value NativeCompiler::visitThisExpression(Environment *, const This *) const
+{
+    supported = false;
+    return Value();
+}
+
+Value NativeCompiler::visitUnaryExpression(Environment *, const Unary *expr) const
+{
+    int to = target;
+    int right = allocate();
+
+    compile(expr->right, right);
+
+    if (expr->op->type == TokenType::BANG)
+    {
+        assembler.truthy(right);
+        assembler.invertTruth();
+        assembler.storeTruth(to);
+        return Value();
+    }
+
+    size_t notNumber = assembler.jumpIfNotNumber(right);
+    assembler.negate(to, right);
+    size_t done = assembler.jump();
+
+    assembler.bind(notNumber);
+    call(reinterpret_cast<const void *>(runtimeUnary), right, expr);
+    assembler.copy(to, right);
+    assembler.bind(done);
+    return Value();
+}
+
+Value NativeCompiler::visitVariableExpression(Environment *, const Variable *expr) const
+{
+    int slot = local(expr->slot);
+
+    if (slot >= 0)
+        assembler.copy(target, slot);
+    else
+        call(reinterpret_cast<const void *>(runtimeGet), target, access(expr->name, expr->upvalue));
+
+    return Value();
+}
+
+/* 
+STATEMENTS 
+*/
+
+Completion NativeCompiler::visitBlockStatement(Environment *, const Block *stmt) const
+{
+    int saved = top;
+
+    scopes.push_back(vector<int>());
+    compile(stmt->statements);
+    scopes.pop_back();
+    top = saved;
+
+    return Completion();
+}
+
+Completion NativeCompiler::visitClassStatement(Environment *, const Class *) const
+{
+    supported = false;
+    return Completion();
+}
+
+Completion NativeCompiler::visitExpressionStatementStatement(Environment *, const ExpressionStatement *stmt) const
+{
+    int value = allocate();
+
+    compile(stmt->expression, value);
+    top = value;
+
+    return Completion();
+}
+
+Completion NativeCompiler::visitFunctionStatement(Environment *, const Function *) const
+{
+    supported = false;
+    return Completion();
+}
+
+Completion NativeCompiler::visitIfStatement(Environment *, const If *stmt) const
+{
+    int condition = allocate();
+
+    compile(stmt->condition, condition);
+    assembler.truthy(condition);
+    top = condition;
+
+    size_t elseJump = assembler.jumpIfFalse();
+    compile(stmt->thenBranch);
+
+    if (stmt->elseBranch == nullptr)
+    {
+        assembler.bind(elseJump);
+        return Completion();
+    }
+
+    size_t endJump = assembler.jump();
+    assembler.bind(elseJump);
+    compile(stmt->elseBranch);
+    assembler.bind(endJump);
+
+    return Completion();
+}
+
+Completion NativeCompiler::visitPrintStatement(Environment *, const Print *stmt) const
+{
+    int value = allocate();
+
+    compile(stmt->expression, value);
+    call(reinterpret_cast<const void *>(runtimePrint), value, nullptr);
+    top = value;
+
+    return Completion();
+}
+
+Completion NativeCompiler::visitReturnStatement(Environment *, const Return *stmt) const
+{
+    // The result goes in the frame's first slot. A tail call leaves its
+    // callee there instead when the caller is to make the call.
+    if (stmt->tailCall)
+    {
+        int callee = operands(static_cast<const Call *>(stmt->value));
+
+        call(reinterpret_cast<const void *>(runtimeTailCall), callee, stmt->value);
+        assembler.copy(0, callee);
+        top = callee;
+    }
+    else if (stmt->value != nullptr)
+    {
+        int value = allocate();
+        compile(stmt->value, value);
+        assembler.copy(0, value);
+        top = value;
+    }
+    else
+    {
+        assembler.storeType(0, ValueType::NIL);
+    }
+
+    returns.push_back(assembler.jump());
+    return Completion();
+}
+
+Completion NativeCompiler::visitVarStatement(Environment *, const Var *stmt) const
+{
+    int slot = allocate();
+
+    if (stmt->initializer != nullptr)
+        compile(stmt->initializer, slot);
+    else
+        assembler.storeType(slot, ValueType::NIL);
+
+    scopes.back().push_back(slot);
+    return Completion();
+}
+
+Completion NativeCompiler::visitWhileStatement(Environment *, const While *stmt) const
+{
+    size_t start = assembler.here();
+    int condition = allocate();
+
+    compile(stmt->condition, condition);
+    assembler.truthy(condition);
+    top = condition;
+
+    size_t exitJump = assembler.jumpIfFalse();
+    compile(stmt->body);
+    assembler.jumpBack(start);
+    assembler.bind(exitJump);
+
+    return Completion();
+}
+
+/* 
+OTHER 
+*/
+
+bool NativeCompiler::compile(const Function *function)
+{
+    assembler.prologue();
+
+    // Slot 0 holds the result, the parameters follow.
+    top = 1;
+    native.frameSize = 1;
+    scopes.push_back(vector<int>());
+
+    for (size_t i = 0; i < function->params.size(); i++)
+        scopes.back().push_back(allocate());
+
+    compile(function->body);
+
+    for (size_t jump : returns)
+        assembler.bind(jump);
+
+    assembler.epilogue(0);
+
+    for (size_t jump : failures)
+        assembler.bind(jump);
+
+    assembler.epilogue(1);
+
+    return supported && native.load(assembler.code());
+}
@@ -0,0 +1,77 @@
+#ifndef _NATIVE_COMPILER_HPP
+#define _NATIVE_COMPILER_HPP
+
+#include <ast/expression.hpp>
+#include <ast/statement.hpp>
+#include <environment/environment.hpp>
+#include <jit/assembler.hpp>
+#include <jit/native_code.hpp>
+#include <vector>
+
+namespace Lox
+{
+    // Turns a resolved function into machine code, one template per node.
+    // Every local and temporary gets its own slot in the frame. Numbers are
+    // added, compared and negated inline when both operands are numbers;
+    // calls, strings, other variables and every error go through the
+    // runtime. Functions with nested functions or classes are refused, so
+    // nothing can capture a frame slot.
+    class NativeCompiler : public ExpressionVisitor,
+                           public StatementVisitor
+    {
+    private:
+        NativeCode &native;
+        mutable Assembler assembler;
+        // Frame slots of the locals in each scope, by resolver index.
+        mutable std::vector<std::vector<int>> scopes;
+        mutable std::vector<size_t> returns;
+        mutable std::vector<size_t> failures;
+        // Slot the expression being compiled leaves its value in.
+        mutable int target;
+        // First slot that isn't holding a live local or temporary.
+        mutable int top;
+        mutable bool supported;
+
+        int allocate(void) const;
+        int local(const Slot &slot) const;
+        const NativeAccess *access(const Token *name, const int upvalue) const;
+        int operands(const Call *expr) const;
+        void call(const void *function, int slot, const void *node) const;
+        void compile(const Expression *expr, int to) const;
+        void compile(const Statement *stmt) const;
+        void compile(NodeList<const Statement *> statements) const;
+
+    public:
+        NativeCompiler(NativeCode &native);
+
+        // EXPRESSIONS
+        Value visitAssignExpression(Environment *env, const Assign *expr) const override;
+        Value visitBinaryExpression(Environment *env, const Binary *expr) const override;
+        Value visitCallExpression(Environment *env, const Call *expr) const override;
+        Value visitGetExpression(Environment *env, const Get *expr) const override;
+        Value visitGroupingExpression(Environment *env, const Grouping *expr) const override;
+        Value visitLiteralExpression(Environment *env, const Literal *expr) const override;
+        Value visitLogicalExpression(Environment *env, const Logical *expr) const override;
+        Value visitSetExpression(Environment *env, const Set *expr) const override;
+        Value visitSuperExpression(Environment *env, const Super *expr) const override;
+        Value visitThisExpression(Environment *env, const This *expr) const override;
+        Value visitUnaryExpression(Environment *env, const Unary *expr) const override;
+        Value visitVariableExpression(Environment *env, const Variable *expr) const override;
+
+        // STATEMENTS
+        Completion visitBlockStatement(Environment *env, const Block *stmt) const override;
+        Completion visitClassStatement(Environment *env, const Class *stmt) const override;
+        Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const override;
+        Completion visitFunctionStatement(Environment *env, const Function *stmt) const override;
+        Completion visitIfStatement(Environment *env, const If *stmt) const override;
+        Completion visitPrintStatement(Environment *env, const Print *stmt) const override;
+        Completion visitReturnStatement(Environment *env, const Return *stmt) const override;
+        Completion visitVarStatement(Environment *env, const Var *stmt) const override;
+        Completion visitWhileStatement(Environment *env, const While *stmt) const override;
+
+        // OTHER
+        bool compile(const Function *function);
+    };
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <scanner/token.hpp>
 #include <ast/expression.hpp>
 #include <string>
+#include <cstdlib>
 #include <any>
 
 using namespace Lox;
@@ -11,14 +12,54 @@ using namespace std;
 
 int main(int argc, char **argv)
 {
-	if (argc > 2)
+	char *script = nullptr;
+
+	for (int i = 1; i < argc; i++)
 	{
-		cout << "Usage: cpp_lox [script]" << endl;
-		return 1;
+		string arg = argv[i];
+
+		if (arg == "--vm")
+		{
+			REPL::setEngine(Engine::VM);
+		}
+		else if (arg == "--closures")
+		{
+			REPL::setEngine(Engine::CLOSURES);
+		}
+		else if (arg == "--emit-cpp")
+		{
+			REPL::setEngine(Engine::EMIT_CPP);
+		}
+		else if (arg == "--no-jit")
+		{
+			REPL::setJit(false);
+		}
+		else if (arg == "--lazy")
+		{
+			REPL::setLazy(true);
+		}
+		else if (arg == "--max-depth" && i + 1 < argc && atoi(argv[i + 1]) > 0)
+		{
+			REPL::setMaxDepth(atoi(argv[++i]));
+		}
+		else if (arg == "--no-cache")
+		{
+			REPL::setCache(false);
+		}
+		else if (arg.rfind("--", 0) != 0 && script == nullptr)
+		{
+			script = argv[i];
+		}
+		else
+		{
+			cout << "Usage: cpp_lox [--vm | --closures | --emit-cpp] [--no-jit] [--no-cache] [--lazy] [--max-depth N] [script]" << endl;
+			return 1;
+		}
 	}
-	else if (argc == 2)
+
+	if (script != nullptr)
 	{
-		REPL::runFile(argv[1]);
+		REPL::runFile(script);
 	}
 	else
 	{
@@ -0,0 +1,402 @@
+#include <optimizer/optimizer.hpp>
+#include <heap/heap.hpp>
+#include <string>
+
+using namespace Lox;
+using namespace std;
+
+Optimizer::Optimizer(Arena &arena) : arena(arena), expression(nullptr), statement(nullptr) {}
+
+/* 
+PRIVATE 
+*/
+
+const Expression *Optimizer::optimize(const Expression *expr) const
+{
+    if (expr == nullptr)
+        return nullptr;
+
+    expr->accept(nullptr, *this);
+    return expression;
+}
+
+const Statement *Optimizer::optimize(const Statement *stmt) const
+{
+    if (stmt == nullptr)
+        return nullptr;
+
+    stmt->accept(nullptr, *this);
+    return statement;
+}
+
+NodeList<const Statement *> Optimizer::optimize(NodeList<const Statement *> statements) const
+{
+    vector<const Statement *> optimized;
+    bool changed = false;
+
+    for (auto stmt : statements)
+    {
+        const Statement *result = optimize(stmt);
+        changed = changed || result != stmt;
+
+        if (result != nullptr)
+            optimized.push_back(result);
+    }
+
+    return changed ? arena.list(optimized) : statements;
+}
+
+// Stands in for a removed statement where the grammar needs one.
+const Statement *Optimizer::empty(void) const
+{
+    return arena.make<Block>(NodeList<const Statement *>());
+}
+
+const Literal *Optimizer::number(double value) const
+{
+    return arena.make<Literal>(Value(value));
+}
+
+const Literal *Optimizer::boolean(bool value) const
+{
+    return arena.make<Literal>(Value(value));
+}
+
+bool Optimizer::isTruthy(const Literal *literal)
+{
+    if (literal->value.type == ValueType::NIL)
+        return false;
+
+    if (literal->value.type == ValueType::BOOLEAN)
+        return literal->value.asBoolean();
+
+    return true;
+}
+
+/* 
+EXPRESSIONS 
+*/
+
+Value Optimizer::visitAssignExpression(Environment *, const Assign *expr) const
+{
+    const Expression *value = optimize(expr->value);
+
+    expression = value == expr->value ? expr : arena.make<Assign>(expr->name, value);
+    return Value();
+}
+
+Value Optimizer::visitBinaryExpression(Environment *, const Binary *expr) const
+{
+    const Expression *left = optimize(expr->left);
+    const Expression *right = optimize(expr->right);
+    auto a = dynamic_cast<const Literal *>(left);
+    auto b = dynamic_cast<const Literal *>(right);
+
+    if (left == expr->left && right == expr->right)
+        expression = expr;
+    else
+        expression = arena.make<Binary>(left, expr->op, right);
+
+    if (a == nullptr || b == nullptr)
+        return Value();
+
+    switch (expr->op->type)
+    {
+    case TokenType::EQUAL_EQUAL:
+    case TokenType::BANG_EQUAL:
+    {
+        bool equal = a->value.type == b->value.type;
+
+        if (equal && a->value.type == ValueType::BOOLEAN)
+            equal = a->value.asBoolean() == b->value.asBoolean();
+        else if (equal && a->value.type == ValueType::NUMBER)
+            equal = a->value.asNumber() == b->value.asNumber();
+        else if (equal && a->value.type == ValueType::STRING)
+            equal = a->value.asString() == b->value.asString();
+
+        expression = boolean(expr->op->type == TokenType::EQUAL_EQUAL ? equal : !equal);
+        return Value();
+    }
+    case TokenType::PLUS:
+        if (a->value.isString() && b->value.isString())
+        {
+            string text = a->value.asString() + b->value.asString();
+            expression = arena.make<Literal>(Heap::instance().constant(text));
+            return Value();
+        }
+        break;
+    default:
+        break;
+    }
+
+    // Mixed operands are type errors, which are reported when they run.
+    if (!a->value.isNumber() || !b->value.isNumber())
+        return Value();
+
+    double x = a->value.asNumber();
+    double y = b->value.asNumber();
+
+    switch (expr->op->type)
+    {
+    case TokenType::GREATER:
+        expression = boolean(x > y);
+        break;
+    case TokenType::GREATER_EQUAL:
+        expression = boolean(x >= y);
+        break;
+    case TokenType::LESS:
+        expression = boolean(x < y);
+        break;
+    case TokenType::LESS_EQUAL:
+        expression = boolean(x <= y);
+        break;
+    case TokenType::MINUS:
+        expression = number(x - y);
+        break;
+    case TokenType::PLUS:
+        expression = number(x + y);
+        break;
+    case TokenType::SLASH:
+        expression = number(x / y);
+        break;
+    case TokenType::STAR:
+        expression = number(x * y);
+        break;
+    default:
+        break;
+    }
+
+    return Value();
+}
+
+Value Optimizer::visitCallExpression(Environment *, const Call *expr) const
+{
+    const Expression *callee = optimize(expr->callee);
+    vector<const Expression *> arguments;
+    bool changed = callee != expr->callee;
+
+    for (auto arg : expr->arguments)
+    {
+        arguments.push_back(optimize(arg));
+        changed = changed || arguments.back() != arg;
+    }
+
+    if (changed)
+        expression = arena.make<Call>(callee, expr->paren, arena.list(arguments));
+    else
+        expression = expr;
+
+    return Value();
+}
+
+Value Optimizer::visitGetExpression(Environment *, const Get *expr) const
+{
+    expression = expr;
+    return Value();
+}
+
+Value Optimizer::visitGroupingExpression(Environment *, const Grouping *expr) const
+{
+    expression = optimize(expr->expression);
+    return Value();
+}
+
+Value Optimizer::visitLiteralExpression(Environment *, const Literal *expr) const
+{
+    expression = expr;
+    return Value();
+}
+
+Value Optimizer::visitLogicalExpression(Environment *, const Logical *expr) const
+{
+    const Expression *left = optimize(expr->left);
+    const Expression *right = optimize(expr->right);
+    auto literal = dynamic_cast<const Literal *>(left);
+
+    if (literal != nullptr)
+    {
+        // The result is the left operand if it decides the outcome, and
+        // the right one otherwise.
+        bool decides = isTruthy(literal) == (expr->op->type == TokenType::OR);
+        expression = decides ? left : right;
+        return Value();
+    }
+
+    if (left == expr->left && right == expr->right)
+        expression = expr;
+    else
+        expression = arena.make<Logical>(left, expr->op, right);
+
+    return Value();
+}
+
+Value Optimizer::visitSetExpression(Environment *, const Set *expr) const
+{
+    expression = expr;
+    return Value();
+}
+
+Value Optimizer::visitSuperExpression(Environment *, const Super *expr) const
+{
+    expression = expr;
+    return Value();
+}
+
+Value Optimizer::visitThisExpression(Environment *, const This *expr) const
+{
+    expression = expr;
+    return Value();
+}
+
+Value Optimizer::visitUnaryExpression(Environment *, const Unary *expr) const
+{
+    const Expression *right = optimize(expr->right);
+    auto literal = dynamic_cast<const Literal *>(right);
+
+    expression = right == expr->right ? expr : arena.make<Unary>(expr->op, right);
+
+    if (literal == nullptr)
+        return Value();
+
+    if (expr->op->type == TokenType::BANG)
+        expression = boolean(!isTruthy(literal));
+    else if (expr->op->type == TokenType::MINUS && literal->value.isNumber())
+        expression = number(-literal->value.asNumber());
+
+    return Value();
+}
+
+Value Optimizer::visitVariableExpression(Environment *, const Variable *expr) const
+{
+    expression = expr;
+    return Value();
+}
+
+/* 
+STATEMENTS 
+*/
+
+Completion Optimizer::visitBlockStatement(Environment *, const Block *stmt) const
+{
+    NodeList<const Statement *> statements = optimize(stmt->statements);
+
+    statement = statements.begin() == stmt->statements.begin() ? stmt : arena.make<Block>(statements);
+    return Completion();
+}
+
+Completion Optimizer::visitClassStatement(Environment *, const Class *stmt) const
+{
+    statement = stmt;
+    return Completion();
+}
+
+Completion Optimizer::visitExpressionStatementStatement(Environment *, const ExpressionStatement *stmt) const
+{
+    const Expression *expr = optimize(stmt->expression);
+
+    if (dynamic_cast<const Literal *>(expr) != nullptr)
+        statement = nullptr;
+    else
+        statement = expr == stmt->expression ? stmt : arena.make<ExpressionStatement>(expr);
+
+    return Completion();
+}
+
+Completion Optimizer::visitFunctionStatement(Environment *, const Function *stmt) const
+{
+    NodeList<const Statement *> body = optimize(stmt->body);
+
+    statement = body.begin() == stmt->body.begin() ? stmt : arena.make<Function>(stmt->name, stmt->params, body);
+    return Completion();
+}
+
+Completion Optimizer::visitIfStatement(Environment *, const If *stmt) const
+{
+    const Expression *condition = optimize(stmt->condition);
+    const Statement *thenBranch = optimize(stmt->thenBranch);
+    const Statement *elseBranch = optimize(stmt->elseBranch);
+    auto literal = dynamic_cast<const Literal *>(condition);
+
+    if (literal != nullptr)
+    {
+        statement = isTruthy(literal) ? thenBranch : elseBranch;
+        return Completion();
+    }
+
+    if (thenBranch == nullptr)
+        thenBranch = empty();
+
+    if (condition == stmt->condition && thenBranch == stmt->thenBranch && elseBranch == stmt->elseBranch)
+        statement = stmt;
+    else
+        statement = arena.make<If>(condition, thenBranch, elseBranch);
+
+    return Completion();
+}
+
+Completion Optimizer::visitPrintStatement(Environment *, const Print *stmt) const
+{
+    const Expression *expr = optimize(stmt->expression);
+
+    statement = expr == stmt->expression ? stmt : arena.make<Print>(expr);
+    return Completion();
+}
+
+Completion Optimizer::visitReturnStatement(Environment *, const Return *stmt) const
+{
+    const Expression *value = optimize(stmt->value);
+
+    statement = value == stmt->value ? stmt : arena.make<Return>(stmt->keyword, value);
+    return Completion();
+}
+
+Completion Optimizer::visitVarStatement(Environment *, const Var *stmt) const
+{
+    const Expression *initializer = optimize(stmt->initializer);
+
+    statement = initializer == stmt->initializer ? stmt : arena.make<Var>(stmt->name, initializer);
+    return Completion();
+}
+
+Completion Optimizer::visitWhileStatement(Environment *, const While *stmt) const
+{
+    const Expression *condition = optimize(stmt->condition);
+    auto literal = dynamic_cast<const Literal *>(condition);
+
+    if (literal != nullptr && !isTruthy(literal))
+    {
+        statement = nullptr;
+        return Completion();
+    }
+
+    const Statement *body = optimize(stmt->body);
+
+    if (body == nullptr)
+        body = empty();
+
+    if (condition == stmt->condition && body == stmt->body)
+        statement = stmt;
+    else
+        statement = arena.make<While>(condition, body);
+
+    return Completion();
+}
+
+/* 
+OTHER 
+*/
+
+vector<const Statement *> Optimizer::optimize(const vector<const Statement *> &statements) const
+{
+    vector<const Statement *> optimized;
+
+    for (auto stmt : statements)
+    {
+        const Statement *result = optimize(stmt);
+
+        if (result != nullptr)
+            optimized.push_back(result);
+    }
+
+    return optimized;
+}
@@ -0,0 +1,67 @@
+#ifndef _OPTIMIZER_HPP
+#define _OPTIMIZER_HPP
+
+#include <ast/expression.hpp>
+#include <ast/statement.hpp>
+#include <ast/arena.hpp>
+#include <environment/environment.hpp>
+#include <vector>
+
+namespace Lox
+{
+    // Rewrites a parse before it is resolved: folds operators whose operands
+    // are literals, drops groupings and removes branches and loops whose
+    // conditions are literals. Anything that would fail at runtime, such as
+    // "a" - 1, is left alone so it still fails there. Nodes that change are
+    // rebuilt in the parse's arena; the rest are shared with the input.
+    class Optimizer : public ExpressionVisitor,
+                      public StatementVisitor
+    {
+    private:
+        Arena &arena;
+        // Output of the last accept(). A null statement has been removed.
+        mutable const Expression *expression;
+        mutable const Statement *statement;
+
+        const Expression *optimize(const Expression *expr) const;
+        const Statement *optimize(const Statement *stmt) const;
+        NodeList<const Statement *> optimize(NodeList<const Statement *> statements) const;
+        const Statement *empty(void) const;
+        const Literal *number(double value) const;
+        const Literal *boolean(bool value) const;
+        static bool isTruthy(const Literal *literal);
+
+    public:
+        Optimizer(Arena &arena);
+
+        // EXPRESSIONS
+        Value visitAssignExpression(Environment *env, const Assign *expr) const override;
+        Value visitBinaryExpression(Environment *env, const Binary *expr) const override;
+        Value visitCallExpression(Environment *env, const Call *expr) const override;
+        Value visitGetExpression(Environment *env, const Get *expr) const override;
+        Value visitGroupingExpression(Environment *env, const Grouping *expr) const override;
+        Value visitLiteralExpression(Environment *env, const Literal *expr) const override;
+        Value visitLogicalExpression(Environment *env, const Logical *expr) const override;
+        Value visitSetExpression(Environment *env, const Set *expr) const override;
+        Value visitSuperExpression(Environment *env, const Super *expr) const override;
+        Value visitThisExpression(Environment *env, const This *expr) const override;
+        Value visitUnaryExpression(Environment *env, const Unary *expr) const override;
+        Value visitVariableExpression(Environment *env, const Variable *expr) const override;
+
+        // STATEMENTS
+        Completion visitBlockStatement(Environment *env, const Block *stmt) const override;
+        Completion visitClassStatement(Environment *env, const Class *stmt) const override;
+        Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const override;
+        Completion visitFunctionStatement(Environment *env, const Function *stmt) const override;
+        Completion visitIfStatement(Environment *env, const If *stmt) const override;
+        Completion visitPrintStatement(Environment *env, const Print *stmt) const override;
+        Completion visitReturnStatement(Environment *env, const Return *stmt) const override;
+        Completion visitVarStatement(Environment *env, const Var *stmt) const override;
+        Completion visitWhileStatement(Environment *env, const While *stmt) const override;
+
+        // OTHER
+        std::vector<const Statement *> optimize(const std::vector<const Statement *> &statements) const;
+    };
+}
+
+#endif
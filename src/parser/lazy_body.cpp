@@ -0,0 +1,22 @@
+#include <parser/lazy_body.hpp>
+#include <interpreter/interpreter.hpp>
+#include <repl/repl.hpp>
+
+using namespace Lox;
+using namespace std;
+
+LazyBody::LazyBody(Arena &arena, std::string_view text, int line)
+    : arena(arena), text(text), line(line), parsed(nullptr)
+{
+}
+
+const Function *LazyBody::parse(const Token &name)
+{
+    if (parsed == nullptr)
+        parsed = REPL::prepareFunction(text, line, arena);
+
+    if (parsed == nullptr)
+        throw RuntimeError(name, "Syntax error in function '" + string(name.lexeme) + "'.");
+
+    return parsed;
+}
@@ -0,0 +1,33 @@
+#ifndef _LAZY_BODY_HPP
+#define _LAZY_BODY_HPP
+
+#include <ast/arena.hpp>
+#include <scanner/token.hpp>
+#include <string_view>
+
+namespace Lox
+{
+    class Function;
+
+    // The body of a top-level function skipped by a lazy parse. Only its
+    // source text is kept, from the function's name to the closing brace,
+    // until the first call parses, optimizes and resolves it into a full
+    // declaration in the same arena.
+    class LazyBody
+    {
+    private:
+        Arena &arena;
+        std::string_view text;
+        int line;
+        const Function *parsed;
+
+    public:
+        LazyBody(Arena &arena, std::string_view text, int line);
+
+        // Syntax errors are reported like any other, then raised as a
+        // RuntimeError at the call. Later calls get the same declaration.
+        const Function *parse(const Token &name);
+    };
+}
+
+#endif
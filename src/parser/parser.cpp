@@ -1,10 +1,15 @@
 #include <parser/parser.hpp>
 #include <repl/repl.hpp>
+#include <heap/heap.hpp>
 
 using namespace Lox;
 using namespace std;
 
-Parser::Parser(vector<Token> tokens) : tokens(tokens), current(0)
+Parser::Parser(const vector<Token> &tokens, Arena &arena) : tokens(tokens), arena(arena), current(0), lazy(false)
+{
+}
+
+Parser::Parser(const vector<Token> &tokens, Arena &arena, bool lazy) : tokens(tokens), arena(arena), current(0), lazy(lazy)
 {
 }
 
@@ -12,18 +17,38 @@ Parser::~Parser(void)
 {
 }
 
-std::vector<std::shared_ptr<const Statement>> Parser::parse(void)
+std::vector<const Statement *> Parser::parse(void)
 {
-    auto statements = vector<shared_ptr<const Statement>>();
+    auto statements = vector<const Statement *>();
 
     while (!isAtEnd())
     {
-        statements.push_back(declaration());
+        if (lazy && check(TokenType::FUN))
+            statements.push_back(lazyFunction());
+        else
+            statements.push_back(declaration());
     }
     return statements;
 }
 
-Parser::ParseError Parser::error(Token token, string message)
+const Function *Parser::parseFunction(void)
+{
+    try
+    {
+        const Statement *function = this->function("function");
+
+        if (!isAtEnd())
+            throw error(peek(), "Expect end of function.");
+
+        return static_cast<const Function *>(function);
+    }
+    catch (ParseError &error)
+    {
+        return nullptr;
+    }
+}
+
+Parser::ParseError Parser::error(const Token &token, string message)
 {
     REPL::error(token, message);
     return ParseError();
@@ -60,17 +85,17 @@ bool Parser::isAtEnd()
     return peek().type == TokenType::ENDOF;
 }
 
-Token Parser::peek()
+const Token &Parser::peek()
 {
     return tokens[current];
 }
 
-Token Parser::previous()
+const Token &Parser::previous()
 {
     return tokens[current - 1];
 }
 
-Token Parser::advance(void)
+const Token &Parser::advance(void)
 {
     if (!isAtEnd())
         current++;
@@ -78,7 +103,7 @@ Token Parser::advance(void)
     return previous();
 }
 
-Token Parser::consume(TokenType type, string message)
+const Token &Parser::consume(TokenType type, string message)
 {
     if (check(type))
         return advance();
@@ -108,12 +133,12 @@ bool Parser::match(Args... types)
     return false;
 }
 
-shared_ptr<Expression> Parser::expression(void)
+const Expression *Parser::expression(void)
 {
     return assignment();
 }
 
-shared_ptr<Statement> Parser::declaration(void)
+const Statement *Parser::declaration(void)
 {
     try
     {
@@ -130,7 +155,7 @@ shared_ptr<Statement> Parser::declaration(void)
     }
 }
 
-shared_ptr<Statement> Parser::statement(void)
+const Statement *Parser::statement(void)
 {
     if (match(TokenType::FOR))
         return forStatement();
@@ -149,17 +174,16 @@ shared_ptr<Statement> Parser::statement(void)
 
     if (match(TokenType::LEFT_BRACE))
     {
-        auto blockStmt = block();
-        return make_shared<Block>(blockStmt);
+        return arena.make<Block>(block());
     }
 
     return expressionStatement();
 }
 
-shared_ptr<Statement> Parser::forStatement(void)
+const Statement *Parser::forStatement(void)
 {
     consume(TokenType::LEFT_PAREN, "Expect '(' after 'for'.");
-    shared_ptr<Statement> initializer;
+    const Statement *initializer;
 
     if (match(TokenType::SEMICOLON))
         initializer = nullptr;
@@ -168,76 +192,68 @@ shared_ptr<Statement> Parser::forStatement(void)
     else
         initializer = expressionStatement();
 
-    shared_ptr<Expression> condition = nullptr;
+    const Expression *condition = nullptr;
 
     if (!check(TokenType::SEMICOLON))
         condition = expression();
 
     consume(TokenType::SEMICOLON, "Expect ';' after loop condition.");
-    shared_ptr<Expression> increment = nullptr;
+    const Expression *increment = nullptr;
 
     if (!check(TokenType::RIGHT_PAREN))
         increment = expression();
 
     consume(TokenType::RIGHT_PAREN, "Expect ')' after for clauses.");
-    shared_ptr<Statement> body = statement();
+    const Statement *body = statement();
 
     if (increment != nullptr)
     {
-        auto stmtList = make_shared<list<shared_ptr<Statement>>>();
-        stmtList->push_back(body);
-        stmtList->push_back(make_shared<ExpressionStatement>(increment));
-
-        body = make_shared<Block>(stmtList);
+        body = arena.make<Block>(arena.list(vector<const Statement *>{
+            body,
+            arena.make<ExpressionStatement>(increment)}));
     }
 
     if (condition == nullptr)
-        condition = make_shared<Literal>(
-            make_shared<TokenType>(TokenType::BOOLEAN),
-            make_shared<std::any>(true));
+        condition = arena.make<Literal>(Value(true));
 
-    body = make_shared<While>(condition, body);
+    body = arena.make<While>(condition, body);
 
     if (initializer != nullptr)
     {
-        auto stmtList = make_shared<list<shared_ptr<Statement>>>();
-        stmtList->push_back(initializer);
-        stmtList->push_back(body);
-
-        body = make_shared<Block>(stmtList);
+        body = arena.make<Block>(arena.list(vector<const Statement *>{initializer, body}));
     }
 
     return body;
 }
 
-shared_ptr<Statement> Parser::ifStatement(void)
+const Statement *Parser::ifStatement(void)
 {
     consume(TokenType::LEFT_PAREN, " Expect '(' after 'if'.");
-    shared_ptr<Expression> condition = expression();
+    const Expression *condition = expression();
     consume(TokenType::RIGHT_PAREN, "Expect ')' after if condition.");
 
-    shared_ptr<Statement> thenBranch = statement();
-    shared_ptr<Statement> elseBranch = nullptr;
+    const Statement *thenBranch = statement();
+    const Statement *elseBranch = nullptr;
 
     if (match(TokenType::ELSE))
         elseBranch = statement();
 
-    return make_shared<If>(condition, thenBranch, elseBranch);
+    return arena.make<If>(condition, thenBranch, elseBranch);
 }
 
-shared_ptr<Statement> Parser::printStatement(void)
+const Statement *Parser::printStatement(void)
 {
-    shared_ptr<Expression> value = expression();
+    const Expression *value = expression();
 
     consume(TokenType::SEMICOLON, "Expect ';' after value.");
 
-    return make_shared<Print>(value);
+    return arena.make<Print>(value);
 }
 
-shared_ptr<Statement> Parser::returnStatement(void)
+const Statement *Parser::returnStatement(void)
 {
-    shared_ptr<Token> keyword = make_shared<Token>(previous());
-    shared_ptr<Expression> value = nullptr;
+    const Token *keyword = arena.make<Token>(previous());
+    const Expression *value = nullptr;
 
     if (!check(TokenType::SEMICOLON))
     {
@@ -246,93 +262,142 @@ shared_ptr<Statement> Parser::returnStatement(void)
 
     consume(TokenType::SEMICOLON, "Expect ';' after return value.");
 
-    return make_shared<Return>(keyword, value);
+    return arena.make<Return>(keyword, value);
 }
 
-std::shared_ptr<Statement> Parser::varDeclaration(void)
+const Statement *Parser::varDeclaration(void)
 {
     Token name = consume(TokenType::IDENTIFIER, "Expect variable name.");
 
-    shared_ptr<Expression> initializer = nullptr;
+    const Expression *initializer = nullptr;
 
     if (match(TokenType::EQUAL))
         initializer = expression();
 
     consume(TokenType::SEMICOLON, "Expect ';' after variable declaration.");
 
-    return make_shared<Var>(make_shared<Token>(name), initializer);
+    return arena.make<Var>(arena.make<Token>(name), initializer);
 }
 
-std::shared_ptr<Statement> Parser::whileStatement(void)
+const Statement *Parser::whileStatement(void)
 {
     consume(TokenType::LEFT_PAREN, "Expect '(' after 'while'.");
-    shared_ptr<Expression> condition = expression();
+    const Expression *condition = expression();
     consume(TokenType::RIGHT_PAREN, "Expect ')' after condition.");
-    shared_ptr<Statement> body = statement();
+    const Statement *body = statement();
 
-    return make_shared<While>(condition, body);
+    return arena.make<While>(condition, body);
 }
 
-shared_ptr<Statement> Parser::expressionStatement(void)
+const Statement *Parser::expressionStatement(void)
 {
-    shared_ptr<Expression> value = expression();
+    const Expression *value = expression();
 
     consume(TokenType::SEMICOLON, "Expect ';' after expression.");
 
-    return make_shared<ExpressionStatement>(value);
+    return arena.make<ExpressionStatement>(value);
 }
 
-std::shared_ptr<Statement> Parser::function(std::string kind)
+const Statement *Parser::function(std::string kind)
 {
-    shared_ptr<Token> name = make_shared<Token>(
+    const Token *name = arena.make<Token>(
         consume(TokenType::IDENTIFIER, "Expect " + kind + " name."));
+    auto parameters = this->parameters(kind);
+
+    consume(TokenType::LEFT_BRACE, "Expect '{' before " + kind + " body.");
+
+    NodeList<const Statement *> body = block();
+
+    return arena.make<Function>(name, arena.list(parameters), body);
+}
+
+vector<const Token *> Parser::parameters(std::string kind)
+{
     consume(TokenType::LEFT_PAREN, "Expect '(' after " + kind + " name.");
 
-    auto parameters = make_shared<list<shared_ptr<Token>>>();
+    auto parameters = vector<const Token *>();
 
     if (!check(TokenType::RIGHT_PAREN))
     {
         do
         {
-            if (parameters->size() >= 255)
+            if (parameters.size() >= 255)
             {
                 error(peek(), "Can't have more than 255 parameters.");
             }
-            parameters->push_back(make_shared<Token>(
+            parameters.push_back(arena.make<Token>(
                 consume(TokenType::IDENTIFIER, "Expect parameter name.")));
         } while (match(TokenType::COMMA));
     }
 
     consume(TokenType::RIGHT_PAREN, "Expect ')' after parameters.");
-    consume(TokenType::LEFT_BRACE, "Expect '{' before " + kind + " body.");
+    return parameters;
+}
+
+// Parses the name and parameters of a top-level function, but only matches
+// braces to find the end of its body. Errors inside the body are found when
+// the function is first called.
+const Statement *Parser::lazyFunction(void)
+{
+    try
+    {
+        advance();
+
+        const Token &start = peek();
+        const Token *name = arena.make<Token>(
+            consume(TokenType::IDENTIFIER, "Expect function name."));
+        auto parameters = this->parameters("function");
+
+        consume(TokenType::LEFT_BRACE, "Expect '{' before function body.");
 
-    shared_ptr<list<shared_ptr<Statement>>> body = block();
+        for (int depth = 1; depth > 0;)
+        {
+            if (isAtEnd())
+                throw error(peek(), "Expect '}' after block.");
+
+            if (match(TokenType::LEFT_BRACE))
+                depth++;
+            else if (match(TokenType::RIGHT_BRACE))
+                depth--;
+            else
+                advance();
+        }
+
+        const char *end = previous().lexeme.data() + previous().lexeme.size();
+        const Function *function = arena.make<Function>(name, arena.list(parameters), NodeList<const Statement *>());
+        function->lazy = arena.make<LazyBody>(arena, string_view(start.lexeme.data(), end - start.lexeme.data()), start.line);
 
-    return make_shared<Function>(name, parameters, body);
+        return function;
+    }
+    catch (ParseError &error)
+    {
+        synchronize();
+        return nullptr;
+    }
 }
 
-shared_ptr<list<shared_ptr<Statement>>> Parser::block(void)
+NodeList<const Statement *> Parser::block(void)
 {
-    auto statements = make_shared<list<shared_ptr<Statement>>>();
+    auto statements = vector<const Statement *>();
 
     while (!check(TokenType::RIGHT_BRACE) && !isAtEnd())
-        statements->push_back(declaration());
+        statements.push_back(declaration());
 
     consume(TokenType::RIGHT_BRACE, "Expect '}' after block.");
-    return statements;
+    return arena.list(statements);
 }
 
-shared_ptr<Expression> Parser::assignment(void)
+const Expression *Parser::assignment(void)
 {
-    shared_ptr<Expression> expr = orOp();
+    const Expression *expr = orOp();
 
     if (match(TokenType::EQUAL))
     {
         Token equals = previous();
-        shared_ptr<Expression> value = assignment();
+        const Expression *value = assignment();
 
-        if (shared_ptr<Variable> variable = dynamic_pointer_cast<Variable>(expr))
-            return make_shared<Assign>(variable->name, value);
+        if (const Variable *variable = dynamic_cast<const Variable *>(expr))
+            return arena.make<Assign>(variable->name, value);
 
         error(equals, "Invalid assignment target.");
     }
@@ -340,124 +405,124 @@ shared_ptr<Expression> Parser::assignment(void)
     return expr;
 }
 
-shared_ptr<Expression> Parser::orOp(void)
+const Expression *Parser::orOp(void)
 {
-    shared_ptr<Expression> expr = andOp();
+    const Expression *expr = andOp();
 
     while (match(TokenType::OR))
     {
-        shared_ptr<Token> op = make_shared<Token>(previous());
-        shared_ptr<Expression> right = andOp();
-        expr = make_shared<Logical>(expr, op, right);
+        const Token *op = arena.make<Token>(previous());
+        const Expression *right = andOp();
+        expr = arena.make<Logical>(expr, op, right);
     }
     return expr;
 }
 
-shared_ptr<Expression> Parser::andOp(void)
+const Expression *Parser::andOp(void)
 {
-    shared_ptr<Expression> expr = equality();
+    const Expression *expr = equality();
 
     while (match(TokenType::AND))
     {
-        shared_ptr<Token> op = make_shared<Token>(previous());
-        shared_ptr<Expression> right = equality();
-        expr = make_shared<Logical>(expr, op, right);
+        const Token *op = arena.make<Token>(previous());
+        const Expression *right = equality();
+        expr = arena.make<Logical>(expr, op, right);
     }
     return expr;
 }
 
-shared_ptr<Expression> Parser::equality(void)
+const Expression *Parser::equality(void)
 {
-    shared_ptr<Expression> expr = comparison();
+    const Expression *expr = comparison();
 
     while (match(TokenType::BANG_EQUAL,
                  TokenType::EQUAL_EQUAL))
     {
-        shared_ptr<Token> op = make_shared<Token>(previous());
-        shared_ptr<Expression> right = comparison();
-        expr = make_shared<Binary>(expr, op, right);
+        const Token *op = arena.make<Token>(previous());
+        const Expression *right = comparison();
+        expr = arena.make<Binary>(expr, op, right);
     }
     return expr;
 }
 
-shared_ptr<Expression> Parser::comparison(void)
+const Expression *Parser::comparison(void)
 {
-    shared_ptr<Expression> expr = term();
+    const Expression *expr = term();
 
     while (match(TokenType::GREATER,
                  TokenType::GREATER_EQUAL,
                  TokenType::LESS,
                  TokenType::LESS_EQUAL))
     {
-        shared_ptr<Token> op = make_shared<Token>(previous());
-        shared_ptr<Expression> right = term();
-        expr = make_shared<Binary>(expr, op, right);
+        const Token *op = arena.make<Token>(previous());
+        const Expression *right = term();
+        expr = arena.make<Binary>(expr, op, right);
     }
     return expr;
 }
 
-shared_ptr<Expression> Parser::term(void)
+const Expression *Parser::term(void)
 {
-    shared_ptr<Expression> expr = factor();
+    const Expression *expr = factor();
 
     while (match(TokenType::MINUS,
                  TokenType::PLUS))
     {
-        shared_ptr<Token> op = make_shared<Token>(previous());
-        shared_ptr<Expression> right = factor();
-        expr = make_shared<Binary>(expr, op, right);
+        const Token *op = arena.make<Token>(previous());
+        const Expression *right = factor();
+        expr = arena.make<Binary>(expr, op, right);
     }
     return expr;
 }
 
-shared_ptr<Expression> Parser::factor(void)
+const Expression *Parser::factor(void)
 {
-    shared_ptr<Expression> expr = unary();
+    const Expression *expr = unary();
 
     while (match(TokenType::SLASH,
                  TokenType::STAR))
     {
-        shared_ptr<Token> op = make_shared<Token>(previous());
-        shared_ptr<Expression> right = unary();
-        expr = make_shared<Binary>(expr, op, right);
+        const Token *op = arena.make<Token>(previous());
+        const Expression *right = unary();
+        expr = arena.make<Binary>(expr, op, right);
     }
     return expr;
 }
 
-shared_ptr<Expression> Parser::unary(void)
+const Expression *Parser::unary(void)
 {
     if (match(TokenType::BANG,
               TokenType::MINUS))
     {
-        shared_ptr<Token> op = make_shared<Token>(previous());
-        shared_ptr<Expression> right = unary();
-        return make_shared<Unary>(op, right);
+        const Token *op = arena.make<Token>(previous());
+        const Expression *right = unary();
+        return arena.make<Unary>(op, right);
     }
     return call();
 }
 
-shared_ptr<Expression> Parser::finishCall(std::shared_ptr<Expression> callee)
+const Expression *Parser::finishCall(const Expression *callee)
 {
-    auto arguments = make_shared<list<shared_ptr<Expression>>>();
+    auto arguments = vector<const Expression *>();
 
     if (!check(TokenType::RIGHT_PAREN))
     {
         do
         {
-            if (arguments->size() >= 255)
+            if (arguments.size() >= 255)
                 error(peek(), "Can't have more than 255 arguments.");
-            arguments->push_back(expression());
+            arguments.push_back(expression());
         } while (match(TokenType::COMMA));
     }
 
-    auto paren = make_shared<Token>(
+    const Token *paren = arena.make<Token>(
         consume(TokenType::RIGHT_PAREN, "Expect ')' after arguments."));
-    return make_shared<Call>(callee, paren, arguments);
+    return arena.make<Call>(callee, paren, arena.list(arguments));
 }
 
-shared_ptr<Expression> Parser::call(void)
+const Expression *Parser::call(void)
 {
-    shared_ptr<Expression> expr = primary();
+    const Expression *expr = primary();
 
     while (true)
     {
@@ -470,28 +535,25 @@ shared_ptr<Expression> Parser::call(void)
     return expr;
 }
 
-shared_ptr<Expression> Parser::primary(void)
+const Expression *Parser::primary(void)
 {
     if (match(TokenType::BOOLEAN))
-        return make_shared<Literal>(make_shared<TokenType>(TokenType::BOOLEAN),
-                                    make_shared<std::any>(previous().literal));
+        return arena.make<Literal>(Value(previous().literal.boolean));
     if (match(TokenType::NIL))
-        return make_shared<Literal>(make_shared<TokenType>(TokenType::NIL),
-                                    make_shared<std::any>(previous().literal));
+        return arena.make<Literal>(Value());
     if (match(TokenType::NUMBER))
-        return make_shared<Literal>(make_shared<TokenType>(TokenType::NUMBER),
-                                    make_shared<std::any>(previous().literal));
+        return arena.make<Literal>(Value(previous().literal.number));
+    // Literal strings are made once, and never collected.
     if (match(TokenType::STRING))
-        return make_shared<Literal>(make_shared<TokenType>(TokenType::STRING),
-                                    make_shared<std::any>(previous().literal));
+        return arena.make<Literal>(Heap::instance().constant(previous().stringValue()));
     if (match(TokenType::IDENTIFIER))
-        return make_shared<Variable>(make_shared<Token>(previous()));
+        return arena.make<Variable>(arena.make<Token>(previous()));
 
     if (match(TokenType::LEFT_PAREN))
     {
-        shared_ptr<Expression> expr = expression();
+        const Expression *expr = expression();
         consume(TokenType::RIGHT_PAREN, "Expected ')' after expression.");
-        return make_shared<Grouping>(expr);
+        return arena.make<Grouping>(expr);
     }
 
     throw error(peek(), "Expected expression.");
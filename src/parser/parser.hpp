@@ -4,6 +4,7 @@
 #include <scanner/token.hpp>
 #include <ast/expression.hpp>
 #include <ast/statement.hpp>
+#include <ast/arena.hpp>
 #include <vector>
 #include <exception>
 #include <memory>
@@ -21,49 +22,57 @@ namespace Lox
             }
         };
 
-        const std::vector<Token> tokens;
+        const std::vector<Token> &tokens;
+        Arena &arena;
         int current;
+        bool lazy;
 
-        ParseError error(Token token, std::string message);
+        ParseError error(const Token &token, std::string message);
         void synchronize(void);
         bool isAtEnd(void);
-        Token peek(void);
-        Token previous(void);
-        Token advance(void);
-        Token consume(TokenType type, std::string message);
+        const Token &peek(void);
+        const Token &previous(void);
+        const Token &advance(void);
+        const Token &consume(TokenType type, std::string message);
         bool check(TokenType type);
         template <typename... Args>
         bool match(Args... types);
 
-        std::shared_ptr<Statement> printStatement(void);
-        std::shared_ptr<Statement> returnStatement(void);
-        std::shared_ptr<Statement> varDeclaration(void);
-        std::shared_ptr<Statement> whileStatement(void);
-        std::shared_ptr<Statement> expressionStatement(void);
-        std::shared_ptr<Statement> function(std::string kind);
-        std::shared_ptr<std::list<std::shared_ptr<Statement>>> block(void);
-        std::shared_ptr<Expression> assignment(void);
-        std::shared_ptr<Expression> orOp(void);
-        std::shared_ptr<Expression> andOp(void);
-        std::shared_ptr<Expression> expression(void);
-        std::shared_ptr<Statement> statement(void);
-        std::shared_ptr<Statement> ifStatement(void);
-        std::shared_ptr<Statement> forStatement(void);
-        std::shared_ptr<Statement> declaration(void);
-        std::shared_ptr<Expression> equality(void);
-        std::shared_ptr<Expression> comparison(void);
-        std::shared_ptr<Expression> term(void);
-        std::shared_ptr<Expression> factor(void);
-        std::shared_ptr<Expression> unary(void);
-        std::shared_ptr<Expression> finishCall(std::shared_ptr<Expression> callee);
-        std::shared_ptr<Expression> call(void);
-        std::shared_ptr<Expression> primary(void);
+        const Statement *printStatement(void);
+        const Statement *returnStatement(void);
+        const Statement *varDeclaration(void);
+        const Statement *whileStatement(void);
+        const Statement *expressionStatement(void);
+        const Statement *function(std::string kind);
+        std::vector<const Token *> parameters(std::string kind);
+        const Statement *lazyFunction(void);
+        NodeList<const Statement *> block(void);
+        const Expression *assignment(void);
+        const Expression *orOp(void);
+        const Expression *andOp(void);
+        const Expression *expression(void);
+        const Statement *statement(void);
+        const Statement *ifStatement(void);
+        const Statement *forStatement(void);
+        const Statement *declaration(void);
+        const Expression *equality(void);
+        const Expression *comparison(void);
+        const Expression *term(void);
+        const Expression *factor(void);
+        const Expression *unary(void);
+        const Expression *finishCall(const Expression *callee);
+        const Expression *call(void);
+        const Expression *primary(void);
 
     public:
-        Parser(std::vector<Token> tokens);
+        Parser(const std::vector<Token> &tokens, Arena &arena);
+        // A lazy parser skips the bodies of top-level functions, see LazyBody.
+        Parser(const std::vector<Token> &tokens, Arena &arena, bool lazy);
         ~Parser(void);
 
-        std::vector<std::shared_ptr<const Statement>> parse(void);
+        std::vector<const Statement *> parse(void);
+        // Parses the text LazyBody keeps: a function without its 'fun'.
+        const Function *parseFunction(void);
     };
 }
 
@@ -0,0 +1,62 @@
+#include <repl/output.hpp>
+
+using namespace Lox;
+using namespace std;
+
+BufferedOutput::BufferedOutput(std::ostream &stream,
+                               bool lineBuffered,
+                               size_t capacity,
+                               std::chrono::milliseconds interval)
+    : stream(stream),
+      buffer(),
+      capacity(capacity),
+      lineBuffered(lineBuffered),
+      interval(interval),
+      lastFlush(chrono::steady_clock::now())
+{
+    buffer.reserve(capacity);
+}
+
+BufferedOutput::~BufferedOutput(void)
+{
+    flush();
+}
+
+void BufferedOutput::write(std::string_view text)
+{
+    buffer.append(text);
+
+    if (lineBuffered && text.find('\n') != string_view::npos)
+        flush();
+    else if (buffer.size() >= capacity)
+        flush();
+    else if (chrono::steady_clock::now() - lastFlush >= interval)
+        flush();
+}
+
+void BufferedOutput::flush(void)
+{
+    if (!buffer.empty())
+    {
+        stream.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+    stream.flush();
+    lastFlush = chrono::steady_clock::now();
+}
+
+void StringOutput::write(std::string_view text)
+{
+    this->text.append(text);
+}
+
+const std::string &StringOutput::str(void) const
+{
+    return text;
+}
+
+void StringOutput::clear(void)
+{
+    text.clear();
+}
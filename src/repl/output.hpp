@@ -0,0 +1,59 @@
+#ifndef _OUTPUT_HPP
+#define _OUTPUT_HPP
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <chrono>
+#include <cstddef>
+
+namespace Lox
+{
+    // Where print statements and runtime errors go. Embedders can install
+    // their own to capture the output of a program.
+    class OutputSink
+    {
+    public:
+        virtual ~OutputSink(void){};
+        virtual void write(std::string_view text) = 0;
+        virtual void flush(void){};
+    };
+
+    // Collects output and hands it to a stream in large writes. It flushes
+    // once the buffer is full, once a write comes in after the interval has
+    // passed, and after every line in line buffered mode.
+    class BufferedOutput : public OutputSink
+    {
+    private:
+        std::ostream &stream;
+        std::string buffer;
+        const size_t capacity;
+        const bool lineBuffered;
+        const std::chrono::milliseconds interval;
+        std::chrono::steady_clock::time_point lastFlush;
+
+    public:
+        BufferedOutput(std::ostream &stream,
+                       bool lineBuffered,
+                       size_t capacity = 64 * 1024,
+                       std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+        ~BufferedOutput(void);
+
+        void write(std::string_view text) override;
+        void flush(void) override;
+    };
+
+    // Keeps everything written to it in memory.
+    class StringOutput : public OutputSink
+    {
+    private:
+        std::string text;
+
+    public:
+        void write(std::string_view text) override;
+        const std::string &str(void) const;
+        void clear(void);
+    };
+}
+
+#endif
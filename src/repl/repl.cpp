@@ -1,8 +1,12 @@
 #include <repl/repl.hpp>
 #include <scanner/scanner.hpp>
 #include <parser/parser.hpp>
+#include <optimizer/optimizer.hpp>
+#include <compiler/compiler.hpp>
+#include <transpiler/transpiler.hpp>
+#include <repl/source_file.hpp>
 #include <iostream>
-#include <fstream>
+#include <unistd.h>
 #include <vector>
 #include <memory>
 #include <any>
@@ -12,70 +16,212 @@ using namespace std;
 
 bool REPL::hadError = false;
 bool REPL::hadRuntimeError = false;
+Engine REPL::engine = Engine::TREE_WALKER;
+bool REPL::lazy = false;
+size_t REPL::maxDepth = CallDepth::UNLIMITED;
+BufferedOutput REPL::standardOutput = BufferedOutput(cout, isatty(STDOUT_FILENO));
+OutputSink *REPL::output = &REPL::standardOutput;
+vector<unique_ptr<Arena>> REPL::arenas = vector<unique_ptr<Arena>>();
 Interpreter REPL::interpreter = Interpreter();
-Resolver REPL::resolver = Resolver(interpreter);
+Resolver REPL::resolver = Resolver();
+ClosureCompiler REPL::closures = ClosureCompiler();
+VM REPL::vm = VM();
+ProgramCache REPL::cache = ProgramCache();
 
 void REPL::error(int line, std::string message)
 {
     report(line, "", message);
 }
 
-void REPL::error(Token token, std::string message)
+void REPL::error(const Token &token, std::string message)
 {
     if (token.type == TokenType::ENDOF)
         report(token.line, " at end ", message);
     else
-        report(token.line, " at '" + token.lexeme + "'", message);
+        report(token.line, " at '" + string(token.lexeme) + "'", message);
 }
 
 void REPL::runtimeError(RuntimeError error)
 {
-    cout << "[line " << error.token.line << "] " << error.message << endl;
+    output->write("[line " + to_string(error.token.line) + "] " + error.message + "\n");
+    output->flush();
     hadRuntimeError = true;
 }
 
 void REPL::report(int line, std::string where, std::string message)
 {
+    // Keep what was printed so far ahead of the error.
+    output->flush();
     cerr << "[line " << line << "] Error" << where << ": " << message << endl;
     hadError = true;
 }
 
-void REPL::run(string source)
+void REPL::setEngine(Engine engine)
+{
+    REPL::engine = engine;
+}
+
+void REPL::setJit(bool enabled)
+{
+    interpreter.jit.setEnabled(enabled);
+}
+
+void REPL::setCache(bool enabled)
+{
+    cache.setEnabled(enabled);
+}
+
+void REPL::setLazy(bool enabled)
+{
+    lazy = enabled;
+}
+
+void REPL::setMaxDepth(size_t depth)
+{
+    maxDepth = depth;
+    interpreter.setMaxDepth(depth);
+    closures.setMaxDepth(depth);
+    vm.setMaxDepth(depth);
+}
+
+void REPL::setOutput(OutputSink &sink)
+{
+    output->flush();
+    output = &sink;
+}
+
+void REPL::print(std::string_view text)
+{
+    output->write(text);
+    output->write("\n");
+}
+
+void REPL::flush(void)
+{
+    output->flush();
+}
+
+Arena &REPL::newArena(void)
+{
+    arenas.push_back(make_unique<Arena>());
+    return *arenas.back();
+}
+
+// Static errors are reported for the program as written, so they don't
+// depend on what the optimizer drops as dead code. The optimized tree is
+// then resolved again for the engines.
+void REPL::analyze(Arena &arena, vector<const Statement *> &statements)
+{
+    Resolver().resolve(interpreter.globals, statements);
+
+    if (hadError)
+        return;
+
+    statements = Optimizer(arena).optimize(statements);
+    Resolver().resolve(interpreter.globals, statements);
+}
+
+// Scans, parses, optimizes and resolves a program, ready for any engine.
+bool REPL::prepare(std::string_view source, Arena &arena, vector<const Statement *> &statements)
 {
     Scanner scanner = Scanner(source);
     const vector<Token> &tokens = scanner.scanTokens();
-    Parser parser = Parser(tokens);
-    vector<shared_ptr<const Statement>> statements = parser.parse();
+    // Only the tree-walker calls through LoxFunction, which parses the rest.
+    Parser parser = Parser(tokens, arena, lazy && engine == Engine::TREE_WALKER);
+    statements = parser.parse();
 
     if (hadError)
+        return false;
+
+    analyze(arena, statements);
+
+    return !hadError;
+}
+
+const Function *REPL::prepareFunction(std::string_view text, int line, Arena &arena)
+{
+    bool enclosingError = hadError;
+    hadError = false;
+
+    Scanner scanner = Scanner(text, line);
+    const vector<Token> &tokens = scanner.scanTokens();
+    Parser parser = Parser(tokens, arena);
+    vector<const Statement *> statements = vector<const Statement *>{parser.parseFunction()};
+
+    if (!hadError)
+        analyze(arena, statements);
+
+    bool failed = hadError;
+    hadError = enclosingError || failed;
+
+    return failed ? nullptr : static_cast<const Function *>(statements[0]);
+}
+
+void REPL::execute(vector<const Statement *> &statements)
+{
+    if (engine == Engine::EMIT_CPP)
+    {
+        output->write(Transpiler().transpile(statements));
         return;
+    }
 
-    Resolver resolver = Resolver(interpreter);
-    resolver.resolve(interpreter.globals, statements);
+    if (engine == Engine::VM)
+    {
+        Compiler compiler = Compiler(vm);
+        Value script = compiler.compile(statements);
 
-    if (hadError)
+        if (hadError)
+            return;
+
+        vm.interpret(script);
         return;
+    }
+
+    if (engine == Engine::CLOSURES)
+    {
+        closures.interpret(statements);
+        return;
+    }
 
     interpreter.interpret(statements);
 }
 
+void REPL::run(std::string_view source, Arena &arena)
+{
+    vector<const Statement *> statements;
+
+    if (prepare(source, arena, statements))
+        execute(statements);
+}
+
 void REPL::runFile(char *path)
 {
-    ifstream in_file(path);
-    string in_string;
+    SourceFile file = SourceFile(path);
 
-    if (in_file.is_open())
+    if (!file.isOpen())
     {
-        in_string.assign(istreambuf_iterator<char>(in_file), istreambuf_iterator<char>());
-    }
-    else
-    {
-        cout << "Could not open " << path << endl;
+        output->write("Could not open " + string(path) + "\n");
     }
 
-    in_file.close();
+    CallDepth::run(maxDepth, [&]()
+                   {
+                       Arena &arena = newArena();
+                       vector<const Statement *> statements;
+
+                       if (cache.load(file.text(), arena, statements))
+                       {
+                           execute(statements);
+                       }
+                       else if (prepare(file.text(), arena, statements))
+                       {
+                           // Skipped function bodies only exist as source text.
+                           if (!lazy)
+                               cache.store(file.text(), statements);
+
+                           execute(statements);
+                       } });
 
-    run(in_string);
+    output->flush();
 
     if (hadError)
         exit(EXIT_FAILURE);
@@ -86,15 +232,38 @@ void REPL::runFile(char *path)
 
 istream &REPL::getline(istream &__is, string &__str)
 {
-    cout << "> ";
+    output->write("> ");
+    output->flush();
     return std::getline(__is, __str);
 }
 
 void REPL::runPrompt(void)
 {
-    for (string line; getline(cin, line);)
-    {
-        run(line);
-        hadError = false;
-    }
-}
\ No newline at end of file
+    CallDepth::run(maxDepth, []()
+                   {
+                       for (string line; getline(cin, line);)
+                       {
+                           // The line is reused for the next one, so the arena keeps a copy.
+                           Arena &arena = newArena();
+                           run(arena.text(line), arena);
+                           hadError = false;
+                       } });
+}
+void REPL::runNative(void (*script)(const Interpreter &interpreter))
+{
+    CallDepth::run(maxDepth, [script]()
+                   {
+                       try
+                       {
+                           script(interpreter);
+                       }
+                       catch (RuntimeError &error)
+                       {
+                           runtimeError(error);
+                       } });
+
+    output->flush();
+
+    if (hadRuntimeError)
+        exit(EXIT_FAILURE);
+}
@@ -4,30 +4,75 @@
 #include <interpreter/interpreter.hpp>
 #include <scanner/token.hpp>
 #include <string>
+#include <string_view>
 #include <resolver/resolver.hpp>
+#include <vm/vm.hpp>
+#include <closures/closure_compiler.hpp>
+#include <ast/arena.hpp>
+#include <repl/output.hpp>
+#include <cache/program_cache.hpp>
+#include <memory>
+#include <vector>
 
 namespace Lox
 {
+    enum class Engine
+    {
+        TREE_WALKER,
+        CLOSURES,
+        VM,
+        EMIT_CPP
+    };
+
     class REPL
     {
     private:
         static bool hadError;
         static bool hadRuntimeError;
+        static Engine engine;
+        static bool lazy;
+        // The --max-depth limit, which also sizes the stack scripts run on.
+        static size_t maxDepth;
+        static BufferedOutput standardOutput;
+        static OutputSink *output;
         REPL(void){};
         static void report(int line, std::string where, std::string message);
         static std::istream &getline(std::istream &__is, std::string &__str);
+        // Every parse keeps its nodes alive for the whole session, since
+        // functions declared on one line can be called from a later one.
+        static std::vector<std::unique_ptr<Arena>> arenas;
+        static Arena &newArena(void);
         static Interpreter interpreter;
         static Resolver resolver;
+        static ClosureCompiler closures;
+        static VM vm;
+        static ProgramCache cache;
+        static void analyze(Arena &arena, std::vector<const Statement *> &statements);
+        static bool prepare(std::string_view source, Arena &arena, std::vector<const Statement *> &statements);
+        static void execute(std::vector<const Statement *> &statements);
 
     public:
         static void
         error(int line, std::string message);
-        static void error(Token token, std::string message);
+        static void error(const Token &token, std::string message);
         static void runtimeError(RuntimeError error);
 
-        static void run(std::string source);
+        static void setEngine(Engine engine);
+        static void setJit(bool enabled);
+        static void setCache(bool enabled);
+        static void setLazy(bool enabled);
+        static void setMaxDepth(size_t depth);
+        static void setOutput(OutputSink &sink);
+        static void print(std::string_view text);
+        static void flush(void);
+        static void run(std::string_view source, Arena &arena);
         static void runFile(char *path);
         static void runPrompt(void);
+        // Finishes a function skipped by a lazy parse, or returns null if
+        // it has errors.
+        static const Function *prepareFunction(std::string_view text, int line, Arena &arena);
+        // Entry point of programs written by --emit-cpp.
+        static void runNative(void (*script)(const Interpreter &interpreter));
     };
 }
 
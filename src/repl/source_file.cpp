@@ -0,0 +1,94 @@
+#include <repl/source_file.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+
+using namespace Lox;
+using namespace std;
+
+SourceFile::SourceFile(const char *path)
+    : open(false), mapping(nullptr), length(0), buffer()
+{
+    int fd = ::open(path, O_RDONLY);
+
+    if (fd < 0)
+        return;
+
+    struct stat info;
+
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+        open = map(fd, info.st_size) || read(fd);
+    else
+        open = read(fd);
+
+    // A mapping stays valid after its descriptor is closed.
+    close(fd);
+}
+
+SourceFile::~SourceFile(void)
+{
+    if (mapping != nullptr)
+        munmap(mapping, length);
+}
+
+/*
+PRIVATE
+*/
+
+bool SourceFile::map(int fd, size_t size)
+{
+    // Empty files can't be mapped, but have nothing to scan either.
+    if (size == 0)
+        return true;
+
+    void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (address == MAP_FAILED)
+        return false;
+
+    madvise(address, size, MADV_SEQUENTIAL);
+    mapping = address;
+    length = size;
+    return true;
+}
+
+bool SourceFile::read(int fd)
+{
+    char chunk[64 * 1024];
+
+    for (;;)
+    {
+        ssize_t count = ::read(fd, chunk, sizeof(chunk));
+
+        if (count == 0)
+            return true;
+
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        buffer.append(chunk, count);
+    }
+}
+
+/*
+PUBLIC
+*/
+
+bool SourceFile::isOpen(void) const
+{
+    return open;
+}
+
+string_view SourceFile::text(void) const
+{
+    if (mapping != nullptr)
+        return string_view(static_cast<const char *>(mapping), length);
+
+    return buffer;
+}
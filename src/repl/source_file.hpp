@@ -0,0 +1,35 @@
+#ifndef _SOURCE_FILE_HPP
+#define _SOURCE_FILE_HPP
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace Lox
+{
+    // The text of a script. Regular files are mapped read-only and scanned
+    // in place, anything else (pipes, devices) is read once into an owned
+    // buffer. Tokens point into the text, so it must outlive the program.
+    class SourceFile
+    {
+    private:
+        bool open;
+        void *mapping;
+        size_t length;
+        std::string buffer;
+
+        bool map(int fd, size_t size);
+        bool read(int fd);
+
+    public:
+        SourceFile(const char *path);
+        SourceFile(const SourceFile &) = delete;
+        SourceFile &operator=(const SourceFile &) = delete;
+        ~SourceFile(void);
+
+        bool isOpen(void) const;
+        std::string_view text(void) const;
+    };
+}
+
+#endif
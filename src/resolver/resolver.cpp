@@ -4,223 +4,275 @@
 using namespace Lox;
 using namespace std;
 
-Resolver::Resolver(Interpreter &interpreter)
-    : interpreter(interpreter),
-      scopes(make_shared<deque<unordered_map<string, bool>>>()),
-      currentFunction(new FunctionType())
+Resolver::Resolver(void)
+    : scopes(make_shared<deque<unordered_map<const Symbol *, Local>>>()),
+      currentFunction(new FunctionType()),
+      captures(make_shared<vector<bool>>()),
+      functions(make_shared<vector<FunctionScope>>())
 {
     *currentFunction = FunctionType::NONE;
 }
 
-void Resolver::define(shared_ptr<const Token> name) const
+void Resolver::define(const Token *name) const
 {
     if (scopes->empty())
         return;
 
-    scopes->back()[name->lexeme] = true;
+    scopes->back()[name->symbol].defined = true;
 }
 
-void Resolver::declare(shared_ptr<const Token> name) const
+void Resolver::declare(const Token *name) const
 {
     if (scopes->empty())
         return;
 
-    unordered_map<string, bool> &scope = scopes->back();
+    unordered_map<const Symbol *, Local> &scope = scopes->back();
+    auto search = scope.find(name->symbol);
 
-    if (scope.find(name->lexeme) != scope.end())
+    if (search != scope.end())
+    {
         REPL::error(*name, "Already a variable with this name in this scope.");
+        search->second.defined = false;
+        return;
+    }
 
-    scope[name->lexeme] = false;
+    int slot = scope.size();
+    scope[name->symbol] = Local{false, slot};
 }
 
 void Resolver::beginScope(void) const
 {
-    scopes->push_back(unordered_map<string, bool>());
+    scopes->push_back(unordered_map<const Symbol *, Local>());
+    captures->push_back(false);
 }
 
-void Resolver::endScope(void) const
+int Resolver::endScope(void) const
 {
+    int size = scopes->back().size();
     scopes->pop_back();
+    captures->pop_back();
+    return size;
+}
+
+void Resolver::capture(void) const
+{
+    // The new closure's chain runs through every open scope. Once a scope is
+    // captured, the ones around it already are.
+    for (auto scope = captures->rbegin(); scope != captures->rend() && !*scope; scope++)
+        *scope = true;
 }
 
-void Resolver::resolve(shared_ptr<Environment> env, shared_ptr<const Expression> expr) const
+void Resolver::resolve(Environment *env, const Expression *expr) const
 {
     expr->accept(env, *this);
 }
 
-void Resolver::resolve(shared_ptr<Environment> env, shared_ptr<const Statement> stmt) const
+void Resolver::resolve(Environment *env, const Statement *stmt) const
 {
     stmt->accept(env, *this);
 }
 
-void Resolver::resolve(shared_ptr<Environment> env, shared_ptr<list<shared_ptr<Statement>>> statements) const
+void Resolver::resolve(Environment *env, NodeList<const Statement *> statements) const
 {
-    for (auto stmt : *statements)
+    for (auto stmt : statements)
         resolve(env, stmt);
 }
 
-void Resolver::resolve(shared_ptr<Environment> env, vector<shared_ptr<const Statement>> &statements) const
+void Resolver::resolve(Environment *env, vector<const Statement *> &statements) const
 {
     for (auto stmt : statements)
         resolve(env, stmt);
 }
 
-void Resolver::resolveLocal(shared_ptr<Environment> env,
-                            shared_ptr<const Expression> expr,
-                            shared_ptr<const Token> name) const
+void Resolver::resolveLocal(Slot &slot, int &upvalue, const Token *name) const
 {
-    int depth = 0;
-    auto scope = scopes->rbegin();
+    upvalue = -1;
 
-    while (scope != scopes->rend())
+    for (size_t scope = scopes->size(); scope-- > 0;)
     {
-        auto search = scope->find(name->lexeme);
+        auto search = (*scopes)[scope].find(name->symbol);
 
-        if (search != scope->end())
+        if (search != (*scopes)[scope].end())
         {
-            interpreter.resolve(env, expr, depth);
+            slot = Slot{static_cast<int>(scopes->size() - 1 - scope), search->second.slot};
+
+            // Variables of enclosing functions are reached through upvalues.
+            if (!functions->empty() && scope < functions->back().base)
+                upvalue = resolveUpvalue(functions->size() - 1, scope, search->second.slot);
+
             return;
         }
-        scope++;
-        depth++;
     }
 }
 
-void Resolver::resolveFunction(shared_ptr<Environment> env,
-                               shared_ptr<const Function> function,
+// The function at level captures the variable through the function
+// declaring it, or through the upvalues of each function in between.
+int Resolver::resolveUpvalue(size_t level, size_t scope, int index) const
+{
+    const FunctionScope &function = (*functions)[level];
+    Capture capture = Capture();
+
+    if (level == 0 || scope >= (*functions)[level - 1].base)
+        capture.slot = Slot{static_cast<int>(function.base - 1 - scope), index};
+    else
+        capture.upvalue = resolveUpvalue(level - 1, scope, index);
+
+    vector<Capture> &upvalues = function.function->upvalues;
+
+    for (size_t i = 0; i < upvalues.size(); i++)
+    {
+        if (upvalues[i].upvalue == capture.upvalue &&
+            upvalues[i].slot.depth == capture.slot.depth &&
+            upvalues[i].slot.index == capture.slot.index)
+            return i;
+    }
+
+    upvalues.push_back(capture);
+    return upvalues.size() - 1;
+}
+
+void Resolver::resolveFunction(Environment *env,
+                               const Function *function,
                                const FunctionType type) const
 {
     FunctionType enclosingFunction = *currentFunction;
     *currentFunction = type;
 
+    // A function resolved again lists its upvalues afresh.
+    function->upvalues.clear();
+    functions->push_back(FunctionScope{scopes->size(), function});
     beginScope();
 
-    for (auto param : *function->params)
+    for (auto param : function->params)
     {
         declare(param);
         define(param);
     }
 
     resolve(env, function->body);
-    endScope();
+    function->captured = captures->back();
+    function->scopeSize = endScope();
+    functions->pop_back();
 
     *currentFunction = enclosingFunction;
 }
 
 // EXPRESSIONS
-std::any Resolver::visitAssignExpression(shared_ptr<Environment> env, shared_ptr<const Assign> expr) const
+Value Resolver::visitAssignExpression(Environment *env, const Assign *expr) const
 {
     resolve(env, expr->value);
-    resolveLocal(env, expr, expr->name);
-    return nullptr;
+    resolveLocal(expr->slot, expr->upvalue, expr->name);
+    return Value();
 }
 
-std::any Resolver::visitBinaryExpression(shared_ptr<Environment> env, shared_ptr<const Binary> expr) const
+Value Resolver::visitBinaryExpression(Environment *env, const Binary *expr) const
 {
     resolve(env, expr->left);
     resolve(env, expr->right);
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitCallExpression(shared_ptr<Environment> env, shared_ptr<const Call> expr) const
+Value Resolver::visitCallExpression(Environment *env, const Call *expr) const
 {
     resolve(env, expr->callee);
 
-    for (auto arg : *expr->arguments)
+    for (auto arg : expr->arguments)
         resolve(env, arg);
 
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitGetExpression(shared_ptr<Environment>, shared_ptr<const Get>) const
+Value Resolver::visitGetExpression(Environment *, const Get *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitGroupingExpression(shared_ptr<Environment> env, shared_ptr<const Grouping> expr) const
+Value Resolver::visitGroupingExpression(Environment *env, const Grouping *expr) const
 {
     resolve(env, expr->expression);
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitLiteralExpression(shared_ptr<Environment>, shared_ptr<const Literal>) const
+Value Resolver::visitLiteralExpression(Environment *, const Literal *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitLogicalExpression(shared_ptr<Environment> env, shared_ptr<const Logical> expr) const
+Value Resolver::visitLogicalExpression(Environment *env, const Logical *expr) const
 {
     resolve(env, expr->left);
     resolve(env, expr->right);
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitSetExpression(shared_ptr<Environment>, shared_ptr<const Set>) const
+Value Resolver::visitSetExpression(Environment *, const Set *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitSuperExpression(shared_ptr<Environment>, shared_ptr<const Super>) const
+Value Resolver::visitSuperExpression(Environment *, const Super *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitThisExpression(shared_ptr<Environment>, shared_ptr<const This>) const
+Value Resolver::visitThisExpression(Environment *, const This *) const
 {
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitUnaryExpression(shared_ptr<Environment> env, shared_ptr<const Unary> expr) const
+Value Resolver::visitUnaryExpression(Environment *env, const Unary *expr) const
 {
     resolve(env, expr->right);
-    return nullptr;
+    return Value();
 }
 
-std::any Resolver::visitVariableExpression(shared_ptr<Environment> env, shared_ptr<const Variable> expr) const
+Value Resolver::visitVariableExpression(Environment *, const Variable *expr) const
 {
     if (!scopes->empty())
     {
-        auto search = scopes->back().find(expr->name->lexeme);
-        if (search != scopes->back().end() && search->second == false)
+        auto search = scopes->back().find(expr->name->symbol);
+        if (search != scopes->back().end() && search->second.defined == false)
             REPL::error(*(expr->name), "Can't read local variable in its own initializer.");
     }
 
-    resolveLocal(env, expr, expr->name);
+    resolveLocal(expr->slot, expr->upvalue, expr->name);
 
-    return nullptr;
+    return Value();
 }
 
 // STATEMENTS
-std::any Resolver::visitBlockStatement(shared_ptr<Environment> env, shared_ptr<const Block> stmt) const
+Completion Resolver::visitBlockStatement(Environment *env, const Block *stmt) const
 {
     beginScope();
     resolve(env, stmt->statements);
-    endScope();
-    return nullptr;
+    stmt->captured = captures->back();
+    stmt->scopeSize = endScope();
+    return Completion();
 }
 
-std::any Resolver::visitClassStatement(shared_ptr<Environment>, shared_ptr<const Class>) const
+Completion Resolver::visitClassStatement(Environment *, const Class *) const
 {
-    return nullptr;
+    return Completion();
 }
 
-std::any Resolver::visitExpressionStatementStatement(shared_ptr<Environment> env,
-                                                     shared_ptr<const ExpressionStatement> stmt) const
+Completion Resolver::visitExpressionStatementStatement(Environment *env,
+                                                     const ExpressionStatement *stmt) const
 {
     resolve(env, stmt->expression);
-    return nullptr;
+    return Completion();
 }
 
-std::any Resolver::visitFunctionStatement(shared_ptr<Environment> env, shared_ptr<const Function> stmt) const
+Completion Resolver::visitFunctionStatement(Environment *env, const Function *stmt) const
 {
     declare(stmt->name);
     define(stmt->name);
+    capture();
 
     resolveFunction(env, stmt, FunctionType::FUNCTION);
-    return nullptr;
+    return Completion();
 }
 
-std::any Resolver::visitIfStatement(shared_ptr<Environment> env, shared_ptr<const If> stmt) const
+Completion Resolver::visitIfStatement(Environment *env, const If *stmt) const
 {
     resolve(env, stmt->condition);
     resolve(env, stmt->thenBranch);
@@ -228,16 +280,16 @@ std::any Resolver::visitIfStatement(shared_ptr<Environment> env, shared_ptr<cons
     if (stmt->elseBranch != nullptr)
         resolve(env, stmt->elseBranch);
 
-    return nullptr;
+    return Completion();
 }
 
-std::any Resolver::visitPrintStatement(shared_ptr<Environment> env, shared_ptr<const Print> stmt) const
+Completion Resolver::visitPrintStatement(Environment *env, const Print *stmt) const
 {
     resolve(env, stmt->expression);
-    return nullptr;
+    return Completion();
 }
 
-std::any Resolver::visitReturnStatement(shared_ptr<Environment> env, shared_ptr<const Return> stmt) const
+Completion Resolver::visitReturnStatement(Environment *env, const Return *stmt) const
 {
     if (*currentFunction == FunctionType::NONE)
         REPL::error(*(stmt->keyword), "Can't return from top-level code.");
@@ -245,10 +297,14 @@ std::any Resolver::visitReturnStatement(shared_ptr<Environment> env, shared_ptr<
     if (stmt->value != nullptr)
         resolve(env, stmt->value);
 
-    return nullptr;
+    // Nothing is left to do in the function once the call returns.
+    stmt->tailCall = *currentFunction == FunctionType::FUNCTION &&
+                     dynamic_cast<const Call *>(stmt->value) != nullptr;
+
+    return Completion();
 }
 
-std::any Resolver::visitVarStatement(shared_ptr<Environment> env, shared_ptr<const Var> stmt) const
+Completion Resolver::visitVarStatement(Environment *env, const Var *stmt) const
 {
     declare(stmt->name);
 
@@ -256,12 +312,12 @@ std::any Resolver::visitVarStatement(shared_ptr<Environment> env, shared_ptr<con
         resolve(env, stmt->initializer);
 
     define(stmt->name);
-    return nullptr;
+    return Completion();
 }
 
-std::any Resolver::visitWhileStatement(shared_ptr<Environment> env, shared_ptr<const While> stmt) const
+Completion Resolver::visitWhileStatement(Environment *env, const While *stmt) const
 {
     resolve(env, stmt->condition);
     resolve(env, stmt->body);
-    return nullptr;
+    return Completion();
 }
\ No newline at end of file
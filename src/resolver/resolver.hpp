@@ -3,13 +3,14 @@
 
 #include <ast/expression.hpp>
 #include <ast/statement.hpp>
-#include <interpreter/interpreter.hpp>
 #include <environment/environment.hpp>
 #include <any>
 #include <memory>
 #include <deque>
 #include <unordered_map>
+#include <vector>
 #include <string>
+#include <string_view>
 
 namespace Lox
 {
@@ -23,55 +24,71 @@ namespace Lox
                      public StatementVisitor
     {
     private:
-        const Interpreter &interpreter;
+        struct Local
+        {
+            bool defined;
+            int slot;
+        };
 
-        const std::shared_ptr<std::deque<std::unordered_map<std::string, bool>>> scopes;
+        struct FunctionScope
+        {
+            // Index of the function's outermost scope.
+            size_t base;
+            const Function *function;
+        };
+
+        const std::shared_ptr<std::deque<std::unordered_map<const Symbol *, Local>>> scopes;
         std::unique_ptr<FunctionType> currentFunction;
+        // Per open scope, whether a function is declared in it or in a block
+        // nested in it, so that a closure may keep it alive.
+        const std::shared_ptr<std::vector<bool>> captures;
+        // The functions being resolved, innermost last.
+        const std::shared_ptr<std::vector<FunctionScope>> functions;
 
-        void define(std::shared_ptr<const Token> name) const;
-        void declare(std::shared_ptr<const Token> name) const;
+        void define(const Token *name) const;
+        void declare(const Token *name) const;
         void beginScope(void) const;
-        void endScope(void) const;
-        void resolve(std::shared_ptr<Environment> env, std::shared_ptr<const Expression> expr) const;
-        void resolve(std::shared_ptr<Environment> env, std::shared_ptr<const Statement> stmt) const;
-        void resolve(std::shared_ptr<Environment> env, std::shared_ptr<std::list<std::shared_ptr<Statement>>> statements) const;
-        void resolveLocal(std::shared_ptr<Environment> env,
-                          std::shared_ptr<const Expression> expr,
-                          std::shared_ptr<const Token> name) const;
-        void resolveFunction(std::shared_ptr<Environment> env,
-                             std::shared_ptr<const Function> function,
+        int endScope(void) const;
+        void capture(void) const;
+        void resolve(Environment *env, const Expression *expr) const;
+        void resolve(Environment *env, const Statement *stmt) const;
+        void resolve(Environment *env, NodeList<const Statement *> statements) const;
+        void resolveLocal(Slot &slot, int &upvalue, const Token *name) const;
+        int resolveUpvalue(size_t level, size_t scope, int index) const;
+        void resolveFunction(Environment *env,
+                             const Function *function,
                              const FunctionType type) const;
 
     public:
-        Resolver(Interpreter &interpreter);
+        Resolver(void);
 
         // EXPRESSIONS
-        std::any visitAssignExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Assign> expr) const override;
-        std::any visitBinaryExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Binary> expr) const override;
-        std::any visitCallExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Call> expr) const override;
-        std::any visitGetExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Get> expr) const override;
-        std::any visitGroupingExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Grouping> expr) const override;
-        std::any visitLiteralExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Literal> expr) const override;
-        std::any visitLogicalExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Logical> expr) const override;
-        std::any visitSetExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Set> expr) const override;
-        std::any visitSuperExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Super> expr) const override;
-        std::any visitThisExpression(std::shared_ptr<Environment> env, std::shared_ptr<const This> expr) const override;
-        std::any visitUnaryExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Unary> expr) const override;
-        std::any visitVariableExpression(std::shared_ptr<Environment> env, std::shared_ptr<const Variable> expr) const override;
+        Value visitAssignExpression(Environment *env, const Assign *expr) const override;
+        Value visitBinaryExpression(Environment *env, const Binary *expr) const override;
+        Value visitCallExpression(Environment *env, const Call *expr) const override;
+        Value visitGetExpression(Environment *env, const Get *expr) const override;
+        Value visitGroupingExpression(Environment *env, const Grouping *expr) const override;
+        Value visitLiteralExpression(Environment *env, const Literal *expr) const override;
+        Value visitLogicalExpression(Environment *env, const Logical *expr) const override;
+        Value visitSetExpression(Environment *env, const Set *expr) const override;
+        Value visitSuperExpression(Environment *env, const Super *expr) const override;
+        Value visitThisExpression(Environment *env, const This *expr) const override;
+        Value visitUnaryExpression(Environment *env, const Unary *expr) const override;
+        Value visitVariableExpression(Environment *env, const Variable *expr) const override;
 
         // STATEMENTS
-        std::any visitBlockStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Block> stmt) const override;
-        std::any visitClassStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Class> stmt) const override;
-        std::any visitExpressionStatementStatement(std::shared_ptr<Environment> env, std::shared_ptr<const ExpressionStatement> stmt) const override;
-        std::any visitFunctionStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Function> stmt) const override;
-        std::any visitIfStatement(std::shared_ptr<Environment> env, std::shared_ptr<const If> stmt) const override;
-        std::any visitPrintStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Print> stmt) const override;
-        std::any visitReturnStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Return> stmt) const override;
-        std::any visitVarStatement(std::shared_ptr<Environment> env, std::shared_ptr<const Var> stmt) const override;
-        std::any visitWhileStatement(std::shared_ptr<Environment> env, std::shared_ptr<const While> stmt) const override;
+        Completion visitBlockStatement(Environment *env, const Block *stmt) const override;
+        Completion visitClassStatement(Environment *env, const Class *stmt) const override;
+        Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const override;
+        Completion visitFunctionStatement(Environment *env, const Function *stmt) const override;
+        Completion visitIfStatement(Environment *env, const If *stmt) const override;
+        Completion visitPrintStatement(Environment *env, const Print *stmt) const override;
+        Completion visitReturnStatement(Environment *env, const Return *stmt) const override;
+        Completion visitVarStatement(Environment *env, const Var *stmt) const override;
+        Completion visitWhileStatement(Environment *env, const While *stmt) const override;
 
         // OTHER
-        void resolve(std::shared_ptr<Environment> env, std::vector<std::shared_ptr<const Statement>> &statements) const;
+        void resolve(Environment *env, std::vector<const Statement *> &statements) const;
     };
 }
 
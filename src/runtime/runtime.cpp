@@ -0,0 +1,123 @@
+#include <runtime/runtime.hpp>
+#include <repl/repl.hpp>
+#include <vector>
+
+using namespace Lox;
+using namespace std;
+
+RuntimeFrame::RuntimeFrame(Value *values, size_t size, Environment **environments, size_t environmentCount)
+    : values(values), size(size), environments(environments), environmentCount(environmentCount)
+{
+    Runtime &runtime = Runtime::instance();
+
+    previous = runtime.frames;
+    runtime.frames = this;
+}
+
+RuntimeFrame::~RuntimeFrame(void)
+{
+    Runtime::instance().frames = previous;
+}
+
+Value LoxTranspiledFunction::call(const Interpreter &interpreter, Arguments arguments)
+{
+    return Runtime::run(interpreter, this, arguments.begin());
+}
+
+Runtime::Runtime(void) : frames(nullptr), tailCalled(false)
+{
+    Heap::instance().addRoots(this);
+}
+
+Runtime::~Runtime(void)
+{
+    Heap::instance().removeRoots(this);
+}
+
+Runtime &Runtime::instance(void)
+{
+    static Runtime runtime;
+    return runtime;
+}
+
+Value Runtime::function(TranspiledBody body, const char *name, int arity, Environment *closure)
+{
+    return Value(ValueType::FUNCTION, Heap::instance().allocate<LoxTranspiledFunction>(name, arity, body, closure));
+}
+
+Value Runtime::call(const Interpreter &interpreter, const Token &paren, const Value &callee, Value *args, int count)
+{
+    auto function = callee.type == ValueType::FUNCTION
+                        ? dynamic_cast<LoxTranspiledFunction *>(callee.asObject())
+                        : nullptr;
+
+    if (function == nullptr)
+        return interpreter.call(&paren, callee, Arguments(args, count));
+
+    if (count != function->parameters)
+        throw RuntimeError(paren,
+                           "Expected " + to_string(function->parameters) +
+                               " arguments but got " + to_string(count) +
+                               ".");
+
+    CallDepth::Guard guard = CallDepth::Guard(interpreter.calls, paren);
+    return run(interpreter, function, args);
+}
+
+// A call in tail position leaves the function and its arguments on the
+// interpreter's argument stack for the run() loop of the function being
+// returned from, which calls it in place of the current one. Anything else
+// is called right away.
+Value Runtime::tailCall(const Interpreter &interpreter, const Token &paren, const Value &callee, Value *args, int count)
+{
+    auto function = callee.type == ValueType::FUNCTION
+                        ? dynamic_cast<LoxTranspiledFunction *>(callee.asObject())
+                        : nullptr;
+
+    if (function == nullptr || count != function->parameters)
+        return call(interpreter, paren, callee, args, count);
+
+    interpreter.arguments.push(paren, callee);
+
+    for (int i = 0; i < count; i++)
+        interpreter.arguments.push(paren, args[i]);
+
+    instance().tailCalled = true;
+    return callee;
+}
+
+Value Runtime::run(const Interpreter &interpreter, LoxTranspiledFunction *function, const Value *args)
+{
+    ArgumentStack::Scope scope = ArgumentStack::Scope(interpreter.arguments);
+    Runtime &runtime = instance();
+
+    for (;;)
+    {
+        size_t mark = interpreter.arguments.size();
+        Value result = function->body(function->closure, args);
+
+        if (!runtime.tailCalled)
+            return result;
+
+        runtime.tailCalled = false;
+        function = static_cast<LoxTranspiledFunction *>(result.asObject());
+        args = scope.replace(mark).begin();
+    }
+}
+
+void Runtime::print(const Value &value)
+{
+    REPL::print(Interpreter::stringify(value));
+}
+
+void Runtime::markRoots(Heap &heap) const
+{
+    for (RuntimeFrame *frame = frames; frame != nullptr; frame = frame->previous)
+    {
+        for (size_t i = 0; i < frame->size; i++)
+            heap.mark(frame->values[i]);
+
+        for (size_t i = 0; i < frame->environmentCount; i++)
+            heap.mark(frame->environments[i]);
+    }
+}
@@ -0,0 +1,168 @@
+#ifndef _RUNTIME_HPP
+#define _RUNTIME_HPP
+
+#include <ast/callable.hpp>
+#include <ast/value.hpp>
+#include <environment/environment.hpp>
+#include <interpreter/interpreter.hpp>
+#include <heap/heap.hpp>
+#include <scanner/token.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace Lox
+{
+    // The Values and Environments of a running transpiled function. They
+    // are rooted from construction until the function returns or throws.
+    class RuntimeFrame
+    {
+    public:
+        Value *values;
+        size_t size;
+        Environment **environments;
+        size_t environmentCount;
+        RuntimeFrame *previous;
+
+        RuntimeFrame(Value *values, size_t size, Environment **environments, size_t environmentCount);
+        ~RuntimeFrame(void);
+        RuntimeFrame(const RuntimeFrame &) = delete;
+        RuntimeFrame &operator=(const RuntimeFrame &) = delete;
+    };
+
+    typedef Value (*TranspiledBody)(Environment *closure, const Value *args);
+
+    class LoxTranspiledFunction : public LoxCallable
+    {
+    public:
+        const std::string name;
+        const int parameters;
+        const TranspiledBody body;
+        Environment *closure;
+
+        LoxTranspiledFunction(const std::string &name, int parameters, TranspiledBody body, Environment *closure)
+            : name(name), parameters(parameters), body(body), closure(closure)
+        {
+        }
+
+        long unsigned int arity(void) const override
+        {
+            return parameters;
+        }
+
+        Value call(const Interpreter &interpreter, Arguments arguments) override;
+
+        void trace(Heap &heap) const override
+        {
+            heap.mark(closure);
+        }
+
+        std::string toString(void) const override
+        {
+            return "<fn " + name + ">";
+        }
+    };
+
+    // What programs written out by --emit-cpp link against: the operators,
+    // calls and printing of the Interpreter, with the same results and
+    // error messages, working on Values the program keeps in its frames.
+    class Runtime : public RootSet
+    {
+    private:
+        RuntimeFrame *frames;
+        // Set by tailCall() for the run() loop below the returning function.
+        bool tailCalled;
+
+        Runtime(void);
+        ~Runtime(void);
+
+        friend class RuntimeFrame;
+
+        static void checkNumbers(const Token &op, const Value &left, const Value &right)
+        {
+            if (!left.isNumber() || !right.isNumber())
+                throw RuntimeError(op, "Operands must be numbers.");
+        }
+
+    public:
+        static Runtime &instance(void);
+
+        static double number(uint64_t bits)
+        {
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        static Value add(const Token &op, const Value &left, const Value &right)
+        {
+            if (left.isNumber() && right.isNumber())
+                return Value(left.asNumber() + right.asNumber());
+
+            if (left.isString() && right.isString())
+                return Heap::instance().concat(left, right);
+
+            throw RuntimeError(op, "Operands must be two numbers or two strings.");
+        }
+
+        static Value subtract(const Token &op, const Value &left, const Value &right)
+        {
+            checkNumbers(op, left, right);
+            return Value(left.asNumber() - right.asNumber());
+        }
+
+        static Value multiply(const Token &op, const Value &left, const Value &right)
+        {
+            checkNumbers(op, left, right);
+            return Value(left.asNumber() * right.asNumber());
+        }
+
+        static Value divide(const Token &op, const Value &left, const Value &right)
+        {
+            checkNumbers(op, left, right);
+            return Value(left.asNumber() / right.asNumber());
+        }
+
+        static Value greater(const Token &op, const Value &left, const Value &right)
+        {
+            checkNumbers(op, left, right);
+            return Value(left.asNumber() > right.asNumber());
+        }
+
+        static Value greaterEqual(const Token &op, const Value &left, const Value &right)
+        {
+            checkNumbers(op, left, right);
+            return Value(left.asNumber() >= right.asNumber());
+        }
+
+        static Value less(const Token &op, const Value &left, const Value &right)
+        {
+            checkNumbers(op, left, right);
+            return Value(left.asNumber() < right.asNumber());
+        }
+
+        static Value lessEqual(const Token &op, const Value &left, const Value &right)
+        {
+            checkNumbers(op, left, right);
+            return Value(left.asNumber() <= right.asNumber());
+        }
+
+        static Value negate(const Token &op, const Value &right)
+        {
+            if (!right.isNumber())
+                throw RuntimeError(op, "Operand must be a number.");
+
+            return Value(-right.asNumber());
+        }
+
+        static Value function(TranspiledBody body, const char *name, int arity, Environment *closure);
+        static Value call(const Interpreter &interpreter, const Token &paren, const Value &callee, Value *args, int count);
+        static Value tailCall(const Interpreter &interpreter, const Token &paren, const Value &callee, Value *args, int count);
+        static Value run(const Interpreter &interpreter, LoxTranspiledFunction *function, const Value *args);
+        static void print(const Value &value);
+
+        void markRoots(Heap &heap) const override;
+    };
+}
+
+#endif
@@ -1,15 +1,21 @@
 #include <scanner/scanner.hpp>
 #include <repl/repl.hpp>
 #include <iostream>
+#include <charconv>
 
 using namespace Lox;
 using namespace std;
 
-Scanner::Scanner(string source)
+Scanner::Scanner(std::string_view source)
     : source(source), tokens(vector<Token>()), line(1), start(0), current(0)
 {
 }
 
+Scanner::Scanner(std::string_view source, int line)
+    : source(source), tokens(vector<Token>()), line(line), start(0), current(0)
+{
+}
+
 bool Scanner::isAtEnd(void)
 {
     return current >= (int)source.length();
@@ -30,10 +36,10 @@ char Scanner::advance(void)
     return source[current++];
 }
 
-void Scanner::addToken(TokenType type, std::any literal = nullptr)
+Token &Scanner::addToken(TokenType type)
 {
-    string text = source.substr(start, current - start);
-    tokens.push_back(Token(type, text, literal, line));
+    tokens.push_back(Token(type, source.substr(start, current - start), line));
+    return tokens.back();
 }
 
 bool Scanner::match(char expected)
@@ -78,9 +84,7 @@ void Scanner::matchString(void)
 
     advance();
 
-    string value = source.substr(start + 1, current - start - 2);
-
-    addToken(TokenType::STRING, value);
+    addToken(TokenType::STRING);
 }
 
 void Scanner::matchNumber(void)
@@ -95,28 +99,26 @@ void Scanner::matchNumber(void)
             advance();
     }
 
-    addToken(TokenType::NUMBER, stod(source.substr(start, current - start)));
+    Token &token = addToken(TokenType::NUMBER);
+    from_chars(source.data() + start, source.data() + current, token.literal.number);
 }
 
 void Scanner::matchIdentifier(void)
 {
     TokenType type = TokenType::IDENTIFIER;
-    string literal;
 
     while (isAlphaNumeric(peek()))
         advance();
 
-    literal = source.substr(start, current - start);
-
-    auto search = keywords.find(literal);
+    auto search = keywords.find(source.substr(start, current - start));
 
     if (search != keywords.end())
         type = search->second;
 
-    if (type != TokenType::BOOLEAN)
-        addToken(type, literal);
-    else
-        addToken(type, "true" == literal);
+    Token &token = addToken(type);
+
+    if (type == TokenType::BOOLEAN)
+        token.literal.boolean = token.lexeme == "true";
 }
 
 void Scanner::scanToken(void)
@@ -208,7 +210,7 @@ const vector<Token> &Scanner::scanTokens(void)
         scanToken();
     }
 
-    tokens.push_back(Token(TokenType::ENDOF, "", "", line));
+    tokens.push_back(Token(TokenType::ENDOF, "", line));
 
     return tokens;
 }
\ No newline at end of file
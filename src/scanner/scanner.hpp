@@ -3,17 +3,16 @@
 
 #include <scanner/token.hpp>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 #include <unordered_map>
-#include <any>
 
 namespace Lox
 {
     class Scanner
     {
     private:
-        const std::unordered_map<std::string, TokenType> keywords =
+        const std::unordered_map<std::string_view, TokenType> keywords =
             {{"and", TokenType::AND},
              {"class", TokenType::CLASS},
              {"else", TokenType::ELSE},
@@ -30,7 +29,7 @@ namespace Lox
              {"true", TokenType::BOOLEAN},
              {"var", TokenType::VAR},
              {"while", TokenType::WHILE}};
-        const std::string source;
+        const std::string_view source;
         std::vector<Token> tokens;
         int line;
         int start;
@@ -39,7 +38,7 @@ namespace Lox
         bool isAlpha(char c);
         bool isAlphaNumeric(char c);
         char advance(void);
-        void addToken(TokenType tokenType, std::any literal);
+        Token &addToken(TokenType tokenType);
         bool match(char expected);
         char peek();
         char peekNext();
@@ -49,7 +48,9 @@ namespace Lox
         void scanToken(void);
 
     public:
-        Scanner(std::string source);
+        Scanner(std::string_view source);
+        // For text cut from a larger source, which starts on the given line.
+        Scanner(std::string_view source, int line);
         const std::vector<Token> &scanTokens(void);
     };
 }
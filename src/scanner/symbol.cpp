@@ -0,0 +1,22 @@
+#include <scanner/symbol.hpp>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+using namespace Lox;
+using namespace std;
+
+const Symbol *Symbol::intern(std::string_view name)
+{
+    // Keys are views into the Symbols, which never move or go away.
+    static unordered_map<string_view, unique_ptr<Symbol>> symbols;
+
+    auto search = symbols.find(name);
+
+    if (search != symbols.end())
+        return search->second.get();
+
+    Symbol *symbol = new Symbol(name, std::hash<string_view>()(name));
+    symbols.emplace(string_view(symbol->name), unique_ptr<Symbol>(symbol));
+    return symbol;
+}
@@ -0,0 +1,35 @@
+#ifndef _SYMBOL_HPP
+#define _SYMBOL_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace Lox
+{
+    // An interned identifier. Every token spelling the same name points to
+    // the same Symbol, so names compare by address and their hash is only
+    // computed once. Symbols live as long as the program.
+    class Symbol
+    {
+    private:
+        Symbol(std::string_view name, size_t hash) : name(name), hash(hash){};
+
+    public:
+        const std::string name;
+        const size_t hash;
+
+        Symbol(const Symbol &) = delete;
+        Symbol &operator=(const Symbol &) = delete;
+
+        static const Symbol *intern(std::string_view name);
+    };
+
+    // Hashes maps keyed by Symbol with the cached hash.
+    struct SymbolHash
+    {
+        size_t operator()(const Symbol *symbol) const { return symbol->hash; };
+    };
+}
+
+#endif
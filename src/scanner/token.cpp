@@ -4,9 +4,17 @@
 using namespace Lox;
 using namespace std;
 
-Token::Token(TokenType type, string lexeme, std::any literal, int line)
-    : type(type), lexeme(lexeme), literal(literal), line(line)
+Token::Token(TokenType type, std::string_view lexeme, int line)
+    : type(type), line(line), lexeme(lexeme),
+      symbol(type == TokenType::IDENTIFIER ? Symbol::intern(lexeme) : nullptr)
 {
+    literal.number = 0;
+}
+
+std::string_view Token::stringValue(void) const
+{
+    // The contents of a string literal, without the quotes.
+    return lexeme.substr(1, lexeme.size() - 2);
 }
 
 std::string Token::typeToString() const
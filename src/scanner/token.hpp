@@ -1,9 +1,9 @@
 #ifndef _TOKEN_HPP
 #define _TOKEN_HPP
 
+#include <scanner/symbol.hpp>
 #include <string>
-#include <list>
-#include <any>
+#include <string_view>
 
 namespace Lox
 {
@@ -57,18 +57,27 @@ namespace Lox
         ENDOF
     };
 
+    // Tokens are plain values. The lexeme is a view into the source buffer,
+    // which the parse's Arena keeps alive for as long as the AST.
     class Token
     {
     private:
         std::string typeToString() const;
 
     public:
-        const TokenType type;
-        const std::string lexeme;
-        const std::any literal;
-        const int line;
+        TokenType type;
+        int line;
+        std::string_view lexeme;
+        // The interned name of an identifier, null for other tokens.
+        const Symbol *symbol;
+        union
+        {
+            double number;
+            bool boolean;
+        } literal;
 
-        Token(TokenType type, std::string lexeme, std::any literal, int line);
+        Token(TokenType type, std::string_view lexeme, int line);
+        std::string_view stringValue(void) const;
         std::string toString(void) const;
     };
 }
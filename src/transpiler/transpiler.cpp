@@ -0,0 +1,667 @@
+#include <transpiler/transpiler.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+using namespace Lox;
+using namespace std;
+
+Transpiler::Transpiler(void)
+    : indent(1), function(0), top(0), frameSize(0), environmentTop(0), environmentSize(0)
+{
+}
+
+/* 
+PRIVATE 
+*/
+
+string Transpiler::quote(string_view text)
+{
+    string quoted = "\"";
+    unsigned char previous = 0;
+
+    for (unsigned char c : text)
+    {
+        // A "??" followed by certain characters is a trigraph under
+        // -trigraphs or older standards, so a repeated '?' is escaped.
+        if (c == '"' || c == '\\' || (c == '?' && previous == '?'))
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if (c < 0x20 || c >= 0x7F)
+        {
+            // Octal escapes are always three digits, unlike hex ones.
+            char escape[5];
+            snprintf(escape, sizeof(escape), "\\%03o", c);
+            quoted += escape;
+        }
+        else
+        {
+            quoted += c;
+        }
+        previous = c;
+    }
+
+    return quoted + "\"";
+}
+
+string Transpiler::number(double value)
+{
+    if (isfinite(value))
+    {
+        ostringstream text;
+        text << hexfloat << value;
+        return text.str();
+    }
+
+    // Folding can produce infinities and NaNs, which have no literals. The
+    // bits are kept since NaNs print with their sign.
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    ostringstream text;
+    text << "Runtime::number(0x" << hex << bits << "ull)";
+    return text.str();
+}
+
+void Transpiler::line(const string &code) const
+{
+    body += string(indent * 4, ' ') + code + "\n";
+}
+
+string Transpiler::slot(int index) const
+{
+    return "v[" + to_string(index) + "]";
+}
+
+int Transpiler::allocate(void) const
+{
+    frameSize = max(frameSize, top + 1);
+    return top++;
+}
+
+string Transpiler::token(const Token *token) const
+{
+    auto search = tokenIndices.find(token);
+
+    if (search != tokenIndices.end())
+        return "tokens[" + to_string(search->second) + "]";
+
+    int index = tokenIndices.size();
+    tokenIndices[token] = index;
+    tokens += "    Token(static_cast<TokenType>(" + to_string(static_cast<int>(token->type)) + "), " +
+              quote(token->lexeme) + ", " + to_string(token->line) + "),\n";
+
+    return "tokens[" + to_string(index) + "]";
+}
+
+// Literal strings are made once, when the script starts.
+string Transpiler::constant(const std::string &text) const
+{
+    auto search = stringIndices.find(text);
+
+    if (search != stringIndices.end())
+        return "strings[" + to_string(search->second) + "]";
+
+    int index = stringIndices.size();
+    stringIndices[text] = index;
+    strings += "    strings[" + to_string(index) + "] = Heap::instance().constant(std::string_view(" +
+               quote(text) + ", " + to_string(text.size()) + "));\n";
+
+    return "strings[" + to_string(index) + "]";
+}
+
+// The Environment new scopes and functions are nested in: the innermost
+// captured scope, or the function's own closure.
+string Transpiler::innermostEnvironment(void) const
+{
+    for (auto scope = scopes.rbegin(); scope != scopes.rend(); scope++)
+    {
+        if (!scope->captured)
+            continue;
+
+        if (scope->function == function)
+            return "e[" + to_string(scope->environment) + "]";
+
+        break;
+    }
+
+    return "closure";
+}
+
+string Transpiler::read(const Token *name, const Slot &slot) const
+{
+    if (slot.isGlobal())
+        return "globals->get(" + token(name) + ")";
+
+    size_t index = scopes.size() - 1 - slot.depth;
+    const Scope &scope = scopes[index];
+
+    if (!scope.captured)
+        return this->slot(scope.locals[slot.index]);
+
+    // Only captured scopes have an Environment to step through.
+    int hops = count_if(scopes.begin() + index + 1, scopes.end(), [](const Scope &scope)
+                        { return scope.captured; });
+
+    return innermostEnvironment() + "->getAt(Slot{" + to_string(hops) + ", " + to_string(slot.index) + "})";
+}
+
+string Transpiler::write(const Token *name, const Slot &slot, const string &value) const
+{
+    if (slot.isGlobal())
+        return "globals->assign(" + token(name) + ", " + value + ");";
+
+    size_t index = scopes.size() - 1 - slot.depth;
+    const Scope &scope = scopes[index];
+
+    if (!scope.captured)
+        return this->slot(scope.locals[slot.index]) + " = " + value + ";";
+
+    int hops = count_if(scopes.begin() + index + 1, scopes.end(), [](const Scope &scope)
+                        { return scope.captured; });
+
+    return innermostEnvironment() + "->assignAt(Slot{" + to_string(hops) + ", " + to_string(slot.index) + "}, " + value + ");";
+}
+
+void Transpiler::beginScope(bool captured, int size) const
+{
+    Scope scope = Scope{captured, -1, vector<int>(), function};
+
+    if (captured)
+    {
+        string enclosing = innermostEnvironment();
+
+        scope.environment = environmentTop++;
+        environmentSize = max(environmentSize, environmentTop);
+        line("e[" + to_string(scope.environment) + "] = Heap::instance().allocate<Environment>(" +
+             enclosing + ", " + to_string(size) + ");");
+    }
+
+    scopes.push_back(scope);
+}
+
+void Transpiler::endScope(void) const
+{
+    if (scopes.back().captured)
+        environmentTop--;
+
+    scopes.pop_back();
+}
+
+void Transpiler::compile(const Expression *expr, const string &to) const
+{
+    int saved = top;
+
+    target = to;
+    expr->accept(nullptr, *this);
+    top = saved;
+}
+
+void Transpiler::compile(const Statement *stmt) const
+{
+    stmt->accept(nullptr, *this);
+}
+
+void Transpiler::compile(NodeList<const Statement *> statements) const
+{
+    for (auto stmt : statements)
+        compile(stmt);
+}
+
+string Transpiler::binary(const Binary *expr, const string &left, const string &right) const
+{
+    string operands = "(" + token(expr->op) + ", " + left + ", " + right + ")";
+
+    switch (expr->op->type)
+    {
+    case TokenType::PLUS:
+        return "Runtime::add" + operands;
+    case TokenType::MINUS:
+        return "Runtime::subtract" + operands;
+    case TokenType::STAR:
+        return "Runtime::multiply" + operands;
+    case TokenType::SLASH:
+        return "Runtime::divide" + operands;
+    case TokenType::GREATER:
+        return "Runtime::greater" + operands;
+    case TokenType::GREATER_EQUAL:
+        return "Runtime::greaterEqual" + operands;
+    case TokenType::LESS:
+        return "Runtime::less" + operands;
+    case TokenType::LESS_EQUAL:
+        return "Runtime::lessEqual" + operands;
+    case TokenType::EQUAL_EQUAL:
+        return "Value(Interpreter::isEqual(" + left + ", " + right + "))";
+    case TokenType::BANG_EQUAL:
+        return "Value(!Interpreter::isEqual(" + left + ", " + right + "))";
+    default:
+        return "Value()";
+    }
+}
+
+// Declarations for the frame of the function just written.
+string Transpiler::frame(void) const
+{
+    int size = max(frameSize, 1);
+    string code = "    Value v[" + to_string(size) + "];\n";
+
+    if (environmentSize == 0)
+        return code + "    RuntimeFrame frame = RuntimeFrame(v, " + to_string(size) + ", nullptr, 0);\n";
+
+    code += "    Environment *e[" + to_string(environmentSize) + "] = {};\n";
+    code += "    RuntimeFrame frame = RuntimeFrame(v, " + to_string(size) + ", e, " + to_string(environmentSize) + ");\n";
+    return code;
+}
+
+/* 
+EXPRESSIONS 
+*/
+
+Value Transpiler::visitAssignExpression(Environment *, const Assign *expr) const
+{
+    string to = target;
+    string value = slot(allocate());
+
+    compile(expr->value, value);
+    line(write(expr->name, expr->slot, value));
+    line(to + " = " + value + ";");
+
+    return Value();
+}
+
+Value Transpiler::visitBinaryExpression(Environment *, const Binary *expr) const
+{
+    string to = target;
+    string left = slot(allocate());
+    compile(expr->left, left);
+    string right = slot(allocate());
+    compile(expr->right, right);
+
+    line(to + " = " + binary(expr, left, right) + ";");
+    return Value();
+}
+
+Value Transpiler::visitCallExpression(Environment *, const Call *expr) const
+{
+    string to = target;
+    int callee = allocate();
+
+    compile(expr->callee, slot(callee));
+
+    for (auto arg : expr->arguments)
+        compile(arg, slot(allocate()));
+
+    line(to + " = Runtime::call(*interpreter, " + token(expr->paren) + ", " + slot(callee) +
+         ", v + " + to_string(callee + 1) + ", " + to_string(expr->arguments.size()) + ");");
+    return Value();
+}
+
+Value Transpiler::visitGetExpression(Environment *, const Get *) const
+{
+    line(target + " = Value();");
+    return Value();
+}
+
+Value Transpiler::visitGroupingExpression(Environment *, const Grouping *expr) const
+{
+    compile(expr->expression, target);
+    return Value();
+}
+
+Value Transpiler::visitLiteralExpression(Environment *, const Literal *expr) const
+{
+    switch (expr->value.type)
+    {
+    case ValueType::STRING:
+    {
+        line(target + " = " + constant(expr->value.asString()) + ";");
+        break;
+    }
+    case ValueType::NUMBER:
+        line(target + " = Value(" + number(expr->value.asNumber()) + ");");
+        break;
+    case ValueType::BOOLEAN:
+        line(target + (expr->value.asBoolean() ? " = Value(true);" : " = Value(false);"));
+        break;
+    default:
+        line(target + " = Value();");
+        break;
+    }
+
+    return Value();
+}
+
+Value Transpiler::visitLogicalExpression(Environment *, const Logical *expr) const
+{
+    string to = target;
+
+    compile(expr->left, to);
+
+    if (expr->op->type == TokenType::OR)
+        line("if (!Interpreter::isTruthy(" + to + "))");
+    else
+        line("if (Interpreter::isTruthy(" + to + "))");
+
+    line("{");
+    indent++;
+    compile(expr->right, to);
+    indent--;
+    line("}");
+
+    return Value();
+}
+
+Value Transpiler::visitSetExpression(Environment *, const Set *) const
+{
+    line(target + " = Value();");
+    return Value();
+}
+
+Value Transpiler::visitSuperExpression(Environment *, const Super *) const
+{
+    line(target + " = Value();");
+    return Value();
+}
+
+Value Transpiler::visitThisExpression(Environment *, const This *) const
+{
+    line(target + " = Value();");
+    return Value();
+}
+
+Value Transpiler::visitUnaryExpression(Environment *, const Unary *expr) const
+{
+    string to = target;
+    string right = slot(allocate());
+
+    compile(expr->right, right);
+
+    if (expr->op->type == TokenType::BANG)
+        line(to + " = Value(!Interpreter::isTruthy(" + right + "));");
+    else
+        line(to + " = Runtime::negate(" + token(expr->op) + ", " + right + ");");
+
+    return Value();
+}
+
+Value Transpiler::visitVariableExpression(Environment *, const Variable *expr) const
+{
+    line(target + " = " + read(expr->name, expr->slot) + ";");
+    return Value();
+}
+
+/* 
+STATEMENTS 
+*/
+
+Completion Transpiler::visitBlockStatement(Environment *, const Block *stmt) const
+{
+    int saved = top;
+
+    line("{");
+    indent++;
+    beginScope(stmt->captured, stmt->scopeSize);
+    compile(stmt->statements);
+    endScope();
+    indent--;
+    line("}");
+    top = saved;
+
+    return Completion();
+}
+
+Completion Transpiler::visitClassStatement(Environment *, const Class *) const
+{
+    return Completion();
+}
+
+Completion Transpiler::visitExpressionStatementStatement(Environment *, const ExpressionStatement *stmt) const
+{
+    int value = allocate();
+
+    compile(stmt->expression, slot(value));
+    top = value;
+
+    return Completion();
+}
+
+Completion Transpiler::visitFunctionStatement(Environment *, const Function *stmt) const
+{
+    int id = functions.size();
+    string name = "fn_" + to_string(id) + "_" + string(stmt->name->lexeme);
+    string closure = innermostEnvironment();
+
+    functions.push_back("");
+
+    string enclosingBody = std::move(body);
+    int enclosingIndent = indent;
+    int enclosingFunction = function;
+    int enclosingTop = top;
+    int enclosingFrameSize = frameSize;
+    int enclosingEnvironmentTop = environmentTop;
+    int enclosingEnvironmentSize = environmentSize;
+
+    body.clear();
+    indent = 1;
+    function = id + 1;
+    top = 0;
+    frameSize = 0;
+    environmentTop = 0;
+    environmentSize = 0;
+
+    beginScope(stmt->captured, stmt->scopeSize);
+
+    for (size_t i = 0; i < stmt->params.size(); i++)
+    {
+        string arg = "args[" + to_string(i) + "]";
+
+        if (stmt->captured)
+        {
+            line("e[" + to_string(scopes.back().environment) + "]->define(" + arg + ");");
+            continue;
+        }
+
+        int param = allocate();
+        line(slot(param) + " = " + arg + ";");
+        scopes.back().locals.push_back(param);
+    }
+
+    compile(stmt->body);
+    endScope();
+    line("return Value();");
+
+    functions[id] = "static Value " + name + "([[maybe_unused]] Environment *closure, [[maybe_unused]] const Value *args)\n{\n" +
+                    frame() + body + "}\n";
+
+    body = std::move(enclosingBody);
+    indent = enclosingIndent;
+    function = enclosingFunction;
+    top = enclosingTop;
+    frameSize = enclosingFrameSize;
+    environmentTop = enclosingEnvironmentTop;
+    environmentSize = enclosingEnvironmentSize;
+
+    string value = "Runtime::function(" + name + ", " + quote(stmt->name->lexeme) + ", " +
+                   to_string(stmt->params.size()) + ", " + closure + ")";
+
+    // A scope that declares a function is always captured.
+    if (scopes.empty())
+        line("globals->define(" + quote(stmt->name->lexeme) + ", " + value + ");");
+    else
+        line("e[" + to_string(scopes.back().environment) + "]->define(" + value + ");");
+
+    return Completion();
+}
+
+Completion Transpiler::visitIfStatement(Environment *, const If *stmt) const
+{
+    int condition = allocate();
+
+    compile(stmt->condition, slot(condition));
+    top = condition;
+
+    line("if (Interpreter::isTruthy(" + slot(condition) + "))");
+    line("{");
+    indent++;
+    compile(stmt->thenBranch);
+    indent--;
+    line("}");
+
+    if (stmt->elseBranch != nullptr)
+    {
+        line("else");
+        line("{");
+        indent++;
+        compile(stmt->elseBranch);
+        indent--;
+        line("}");
+    }
+
+    return Completion();
+}
+
+Completion Transpiler::visitPrintStatement(Environment *, const Print *stmt) const
+{
+    int value = allocate();
+
+    compile(stmt->expression, slot(value));
+    line("Runtime::print(" + slot(value) + ");");
+    top = value;
+
+    return Completion();
+}
+
+Completion Transpiler::visitReturnStatement(Environment *, const Return *stmt) const
+{
+    if (stmt->value == nullptr)
+    {
+        line("return Value();");
+        return Completion();
+    }
+
+    if (stmt->tailCall)
+    {
+        auto call = static_cast<const Call *>(stmt->value);
+        int callee = allocate();
+
+        compile(call->callee, slot(callee));
+
+        for (auto arg : call->arguments)
+            compile(arg, slot(allocate()));
+
+        line("return Runtime::tailCall(*interpreter, " + token(call->paren) + ", " + slot(callee) +
+             ", v + " + to_string(callee + 1) + ", " + to_string(call->arguments.size()) + ");");
+        top = callee;
+
+        return Completion();
+    }
+
+    int value = allocate();
+
+    compile(stmt->value, slot(value));
+    line("return " + slot(value) + ";");
+    top = value;
+
+    return Completion();
+}
+
+Completion Transpiler::visitVarStatement(Environment *, const Var *stmt) const
+{
+    bool global = scopes.empty();
+
+    // Uncaptured locals are defined straight into their frame slot.
+    if (!global && !scopes.back().captured)
+    {
+        int local = allocate();
+
+        if (stmt->initializer != nullptr)
+            compile(stmt->initializer, slot(local));
+        else
+            line(slot(local) + " = Value();");
+
+        scopes.back().locals.push_back(local);
+        return Completion();
+    }
+
+    int value = allocate();
+
+    if (stmt->initializer != nullptr)
+        compile(stmt->initializer, slot(value));
+    else
+        line(slot(value) + " = Value();");
+
+    if (global)
+        line("globals->define(" + quote(stmt->name->lexeme) + ", " + slot(value) + ");");
+    else
+        line("e[" + to_string(scopes.back().environment) + "]->define(" + slot(value) + ");");
+
+    top = value;
+    return Completion();
+}
+
+Completion Transpiler::visitWhileStatement(Environment *, const While *stmt) const
+{
+    line("for (;;)");
+    line("{");
+    indent++;
+
+    int condition = allocate();
+
+    compile(stmt->condition, slot(condition));
+    top = condition;
+    line("if (!Interpreter::isTruthy(" + slot(condition) + "))");
+    line("    break;");
+    compile(stmt->body);
+
+    indent--;
+    line("}");
+
+    return Completion();
+}
+
+/* 
+OTHER 
+*/
+
+string Transpiler::transpile(const vector<const Statement *> &statements) const
+{
+    for (auto stmt : statements)
+        compile(stmt);
+
+    string code;
+
+    code += "// Written by cpp_lox --emit-cpp. Build it against the runtime library:\n";
+    code += "//     make runtime\n";
+    code += "//     g++ -std=c++17 -O2 -I src program.cpp bin/liblox.a -o program\n\n";
+    code += "#include <runtime/runtime.hpp>\n";
+    code += "#include <repl/repl.hpp>\n";
+    code += "#include <string>\n\n";
+    code += "using namespace Lox;\n\n";
+    code += "static const Interpreter *interpreter;\n";
+    code += "static Environment *globals;\n\n";
+    code += "static const Token tokens[] = {\n" + tokens + "    Token(TokenType::ENDOF, \"\", 0),\n};\n\n";
+
+    if (!stringIndices.empty())
+        code += "static Value strings[" + to_string(stringIndices.size()) + "];\n\n";
+
+    for (size_t id = 0; id < functions.size(); id++)
+        code += functions[id].substr(0, functions[id].find('\n')) + ";\n";
+
+    for (const string &definition : functions)
+        code += "\n" + definition;
+
+    code += "\nstatic void script(const Interpreter &running)\n{\n";
+    code += "    interpreter = &running;\n";
+    code += "    globals = running.globals;\n";
+    code += strings + "\n";
+    code += frame();
+    code += "    [[maybe_unused]] Environment *closure = globals;\n";
+    code += body + "}\n\n";
+    code += "int main(void)\n{\n    REPL::runNative(script);\n    return 0;\n}\n";
+
+    return code;
+}
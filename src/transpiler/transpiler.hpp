@@ -0,0 +1,104 @@
+#ifndef _TRANSPILER_HPP
+#define _TRANSPILER_HPP
+
+#include <ast/expression.hpp>
+#include <ast/statement.hpp>
+#include <environment/environment.hpp>
+#include <scanner/token.hpp>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Lox
+{
+    // Writes a resolved program out as a C++ source file that links against
+    // the Runtime. Each Lox function becomes a C++ function. Its locals and
+    // temporaries are Values in a frame array, evaluated in the order the
+    // Interpreter evaluates them. Only scopes the resolver marked captured
+    // get an Environment, like in the Interpreter.
+    class Transpiler : public ExpressionVisitor,
+                       public StatementVisitor
+    {
+    private:
+        struct Scope
+        {
+            // Backed by an Environment in e[environment], or by frame slots.
+            bool captured;
+            int environment;
+            std::vector<int> locals;
+            int function;
+        };
+
+        mutable std::vector<Scope> scopes;
+        mutable std::vector<std::string> functions;
+        mutable std::string tokens;
+        mutable std::unordered_map<const Token *, int> tokenIndices;
+        // Statements that fill in the table of string literals.
+        mutable std::string strings;
+        mutable std::unordered_map<std::string, int> stringIndices;
+
+        // The function being written.
+        mutable std::string body;
+        mutable int indent;
+        mutable int function;
+        mutable int top;
+        mutable int frameSize;
+        mutable int environmentTop;
+        mutable int environmentSize;
+        // Where the expression being written leaves its value.
+        mutable std::string target;
+
+        static std::string quote(std::string_view text);
+        static std::string number(double value);
+
+        void line(const std::string &code) const;
+        std::string slot(int index) const;
+        int allocate(void) const;
+        std::string token(const Token *token) const;
+        std::string constant(const std::string &text) const;
+        std::string innermostEnvironment(void) const;
+        std::string read(const Token *name, const Slot &slot) const;
+        std::string write(const Token *name, const Slot &slot, const std::string &value) const;
+        void beginScope(bool captured, int size) const;
+        void endScope(void) const;
+        void compile(const Expression *expr, const std::string &to) const;
+        void compile(const Statement *stmt) const;
+        void compile(NodeList<const Statement *> statements) const;
+        std::string binary(const Binary *expr, const std::string &left, const std::string &right) const;
+        std::string frame(void) const;
+
+    public:
+        Transpiler(void);
+
+        // EXPRESSIONS
+        Value visitAssignExpression(Environment *env, const Assign *expr) const override;
+        Value visitBinaryExpression(Environment *env, const Binary *expr) const override;
+        Value visitCallExpression(Environment *env, const Call *expr) const override;
+        Value visitGetExpression(Environment *env, const Get *expr) const override;
+        Value visitGroupingExpression(Environment *env, const Grouping *expr) const override;
+        Value visitLiteralExpression(Environment *env, const Literal *expr) const override;
+        Value visitLogicalExpression(Environment *env, const Logical *expr) const override;
+        Value visitSetExpression(Environment *env, const Set *expr) const override;
+        Value visitSuperExpression(Environment *env, const Super *expr) const override;
+        Value visitThisExpression(Environment *env, const This *expr) const override;
+        Value visitUnaryExpression(Environment *env, const Unary *expr) const override;
+        Value visitVariableExpression(Environment *env, const Variable *expr) const override;
+
+        // STATEMENTS
+        Completion visitBlockStatement(Environment *env, const Block *stmt) const override;
+        Completion visitClassStatement(Environment *env, const Class *stmt) const override;
+        Completion visitExpressionStatementStatement(Environment *env, const ExpressionStatement *stmt) const override;
+        Completion visitFunctionStatement(Environment *env, const Function *stmt) const override;
+        Completion visitIfStatement(Environment *env, const If *stmt) const override;
+        Completion visitPrintStatement(Environment *env, const Print *stmt) const override;
+        Completion visitReturnStatement(Environment *env, const Return *stmt) const override;
+        Completion visitVarStatement(Environment *env, const Var *stmt) const override;
+        Completion visitWhileStatement(Environment *env, const While *stmt) const override;
+
+        // OTHER
+        std::string transpile(const std::vector<const Statement *> &statements) const;
+    };
+}
+
+#endif
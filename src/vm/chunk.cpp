@@ -0,0 +1,41 @@
+#include <vm/chunk.hpp>
+
+using namespace Lox;
+using namespace std;
+
+void Chunk::write(uint8_t byte, int line)
+{
+    if (lines.empty() || lines.back().line != line)
+        lines.push_back(LineStart{(int)code.size(), line});
+
+    code.push_back(byte);
+}
+
+void Chunk::write(OpCode op, int line)
+{
+    write((uint8_t)op, line);
+}
+
+int Chunk::addConstant(const Value &value)
+{
+    constants.push_back(value);
+    return constants.size() - 1;
+}
+
+int Chunk::getLine(int offset) const
+{
+    int low = 0;
+    int high = lines.size() - 1;
+
+    while (low < high)
+    {
+        int mid = (low + high + 1) / 2;
+
+        if (lines[mid].offset <= offset)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+
+    return lines.empty() ? 0 : lines[low].line;
+}
@@ -0,0 +1,70 @@
+#ifndef _CHUNK_HPP
+#define _CHUNK_HPP
+
+#include <ast/value.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace Lox
+{
+    enum class OpCode : uint8_t
+    {
+        CONSTANT,
+        NIL,
+        TRUE,
+        FALSE,
+        POP,
+        GET_LOCAL,
+        SET_LOCAL,
+        GET_GLOBAL,
+        DEFINE_GLOBAL,
+        SET_GLOBAL,
+        GET_UPVALUE,
+        SET_UPVALUE,
+        EQUAL,
+        NOT_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        LESS,
+        LESS_EQUAL,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        NOT,
+        NEGATE,
+        PRINT,
+        JUMP,
+        JUMP_IF_FALSE,
+        LOOP,
+        CALL,
+        TAIL_CALL,
+        CLOSURE,
+        CLOSE_UPVALUE,
+        RETURN,
+    };
+
+    class Chunk
+    {
+    private:
+        // Run-length encoded, one entry per run of bytes on the same line.
+        struct LineStart
+        {
+            int offset;
+            int line;
+        };
+
+        std::vector<LineStart> lines;
+
+    public:
+        std::vector<uint8_t> code;
+        std::vector<Value> constants;
+
+        void write(uint8_t byte, int line);
+        void write(OpCode op, int line);
+        int addConstant(const Value &value);
+        int getLine(int offset) const;
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef _CLOSURE_HPP
+#define _CLOSURE_HPP
+
+#include <ast/object.hpp>
+#include <ast/value.hpp>
+#include <vm/chunk.hpp>
+#include <heap/heap.hpp>
+#include <vector>
+#include <string>
+
+namespace Lox
+{
+    // A function body compiled to bytecode, shared by every closure over it.
+    class LoxPrototype : public Object
+    {
+    public:
+        int arity;
+        int upvalueCount;
+        Chunk chunk;
+        std::string name;
+
+        LoxPrototype(std::string name) : arity(0), upvalueCount(0), name(name){};
+
+        void trace(Heap &heap) const override
+        {
+            for (const Value &constant : chunk.constants)
+                heap.mark(constant);
+        }
+
+        std::string toString(void) const override
+        {
+            if (name.empty())
+                return "<script>";
+            return "<fn " + name + ">";
+        }
+    };
+
+    // Points at a stack slot while the variable is live, and owns the value
+    // once the enclosing frame has returned.
+    class LoxUpvalue : public HeapObject
+    {
+    public:
+        size_t slot;
+        bool isOpen;
+        Value closed;
+        LoxUpvalue *nextOpen;
+
+        LoxUpvalue(size_t slot) : slot(slot), isOpen(true), closed(), nextOpen(nullptr){};
+
+        void trace(Heap &heap) const override
+        {
+            heap.mark(closed);
+        }
+    };
+
+    class LoxClosure : public Object
+    {
+    public:
+        const Value prototype;
+        std::vector<LoxUpvalue *> upvalues;
+
+        LoxClosure(const Value &prototype)
+            : prototype(prototype),
+              upvalues(static_cast<LoxPrototype *>(prototype.asObject())->upvalueCount){};
+
+        LoxPrototype *function(void) const
+        {
+            return static_cast<LoxPrototype *>(prototype.asObject());
+        }
+
+        void trace(Heap &heap) const override
+        {
+            heap.mark(prototype);
+
+            for (LoxUpvalue *upvalue : upvalues)
+                heap.mark(upvalue);
+        }
+
+        std::string toString(void) const override
+        {
+            return function()->toString();
+        }
+    };
+}
+
+#endif
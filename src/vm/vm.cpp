@@ -0,0 +1,424 @@
+#include <vm/vm.hpp>
+#include <ast/primitive.hpp>
+#include <repl/repl.hpp>
+#include <algorithm>
+
+using namespace Lox;
+using namespace std;
+
+VM::VM(void) : maxFrames(FRAMES_MAX), openUpvalues(nullptr)
+{
+    frames.reserve(FRAMES_MAX);
+    Heap::instance().addRoots(this);
+    defineNative("clock", Value(ValueType::PRIMITIVE, Heap::instance().allocate<LoxPrimitive>(LoxPrimitiveFn::clock)));
+}
+
+VM::~VM(void)
+{
+    Heap::instance().removeRoots(this);
+}
+
+/*
+PRIVATE
+*/
+
+void VM::defineNative(const std::string &name, const Value &value)
+{
+    int slot = globalSlot(name);
+    globalValues[slot] = value;
+    globalDefined[slot] = true;
+}
+
+void VM::resetStack(void)
+{
+    stack.clear();
+    frames.clear();
+    openUpvalues = nullptr;
+}
+
+RuntimeError VM::error(const std::string &message) const
+{
+    const CallFrame &frame = frames.back();
+    const Chunk &chunk = frame.closure->function()->chunk;
+    int line = chunk.getLine(frame.ip - chunk.code.data() - 1);
+
+    return RuntimeError(Token(TokenType::ENDOF, "", line), message);
+}
+
+void VM::call(int argCount)
+{
+    size_t base = stack.size() - argCount - 1;
+    const Value &callee = stack[base];
+
+    if (callee.type == ValueType::CLOSURE)
+    {
+        LoxClosure *closure = static_cast<LoxClosure *>(callee.asObject());
+
+        if (argCount != closure->function()->arity)
+            throw error("Expected " + to_string(closure->function()->arity) +
+                        " arguments but got " + to_string(argCount) + ".");
+
+        if (frames.size() == maxFrames)
+            throw error("Stack overflow.");
+
+        frames.push_back(CallFrame{closure, closure->function()->chunk.code.data(), base});
+        return;
+    }
+    if (callee.type == ValueType::PRIMITIVE)
+    {
+        LoxPrimitive *primitive = static_cast<LoxPrimitive *>(callee.asObject());
+
+        if ((long unsigned int)argCount != primitive->arity())
+            throw error("Expected " + to_string(primitive->arity()) +
+                        " arguments but got " + to_string(argCount) + ".");
+
+        Value result = primitive->invoke(Arguments(&stack[base + 1], argCount));
+        stack.resize(base);
+        stack.push_back(result);
+        return;
+    }
+
+    throw error("Can only call functions and classes.");
+}
+
+// A closure called from a return replaces the returning frame: its callee
+// and arguments move down over the frame's slots, so tail recursion runs
+// in constant stack. Anything else is called as usual, and the RETURN
+// after the call returns its result.
+void VM::tailCall(int argCount)
+{
+    size_t base = stack.size() - argCount - 1;
+    const Value &callee = stack[base];
+
+    if (callee.type != ValueType::CLOSURE ||
+        argCount != static_cast<LoxClosure *>(callee.asObject())->function()->arity)
+    {
+        call(argCount);
+        return;
+    }
+
+    CallFrame &frame = frames.back();
+    LoxClosure *closure = static_cast<LoxClosure *>(callee.asObject());
+
+    closeUpvalues(frame.base);
+    copy(stack.begin() + base, stack.end(), stack.begin() + frame.base);
+    stack.resize(frame.base + argCount + 1);
+    frame = CallFrame{closure, closure->function()->chunk.code.data(), frame.base};
+}
+
+LoxUpvalue *VM::captureUpvalue(size_t slot)
+{
+    LoxUpvalue *previous = nullptr;
+    LoxUpvalue *upvalue = openUpvalues;
+
+    while (upvalue != nullptr && upvalue->slot > slot)
+    {
+        previous = upvalue;
+        upvalue = upvalue->nextOpen;
+    }
+
+    if (upvalue != nullptr && upvalue->slot == slot)
+        return upvalue;
+
+    LoxUpvalue *created = Heap::instance().allocate<LoxUpvalue>(slot);
+    created->nextOpen = upvalue;
+
+    if (previous == nullptr)
+        openUpvalues = created;
+    else
+        previous->nextOpen = created;
+
+    return created;
+}
+
+void VM::closeUpvalues(size_t last)
+{
+    while (openUpvalues != nullptr && openUpvalues->slot >= last)
+    {
+        LoxUpvalue *upvalue = openUpvalues;
+        upvalue->closed = stack[upvalue->slot];
+        upvalue->isOpen = false;
+        openUpvalues = upvalue->nextOpen;
+        upvalue->nextOpen = nullptr;
+    }
+}
+
+Value &VM::upvalueValue(LoxUpvalue &upvalue)
+{
+    return upvalue.isOpen ? stack[upvalue.slot] : upvalue.closed;
+}
+
+void VM::run(void)
+{
+    CallFrame *frame = &frames.back();
+
+#define READ_BYTE() (*frame->ip++)
+#define READ_SHORT() (frame->ip += 2, (uint16_t)((frame->ip[-2] << 8) | frame->ip[-1]))
+#define NUMBER_OP(op)                                         \
+    {                                                         \
+        const Value &right = stack.back();                    \
+        const Value &left = stack[stack.size() - 2];          \
+        if (!left.isNumber() || !right.isNumber())            \
+            throw error("Operands must be numbers.");         \
+        Value result = Value(left.asNumber() op right.asNumber()); \
+        stack.pop_back();                                     \
+        stack.back() = result;                                \
+    }
+
+    for (;;)
+    {
+        switch ((OpCode)READ_BYTE())
+        {
+        case OpCode::CONSTANT:
+            stack.push_back(frame->closure->function()->chunk.constants[READ_SHORT()]);
+            break;
+        case OpCode::NIL:
+            stack.push_back(Value());
+            break;
+        case OpCode::TRUE:
+            stack.push_back(Value(true));
+            break;
+        case OpCode::FALSE:
+            stack.push_back(Value(false));
+            break;
+        case OpCode::POP:
+            stack.pop_back();
+            break;
+        case OpCode::GET_LOCAL:
+            stack.push_back(stack[frame->base + READ_BYTE()]);
+            break;
+        case OpCode::SET_LOCAL:
+            stack[frame->base + READ_BYTE()] = stack.back();
+            break;
+        case OpCode::GET_GLOBAL:
+        {
+            uint16_t slot = READ_SHORT();
+
+            if (!globalDefined[slot])
+                throw error("Undefined global variable '" + globalNames[slot] + "'.");
+
+            stack.push_back(globalValues[slot]);
+            break;
+        }
+        case OpCode::DEFINE_GLOBAL:
+        {
+            uint16_t slot = READ_SHORT();
+            globalValues[slot] = stack.back();
+            globalDefined[slot] = true;
+            stack.pop_back();
+            break;
+        }
+        case OpCode::SET_GLOBAL:
+        {
+            uint16_t slot = READ_SHORT();
+
+            if (!globalDefined[slot])
+                throw error("Undefined variable '" + globalNames[slot] + "'.");
+
+            globalValues[slot] = stack.back();
+            break;
+        }
+        case OpCode::GET_UPVALUE:
+            stack.push_back(upvalueValue(*frame->closure->upvalues[READ_BYTE()]));
+            break;
+        case OpCode::SET_UPVALUE:
+            upvalueValue(*frame->closure->upvalues[READ_BYTE()]) = stack.back();
+            break;
+        case OpCode::EQUAL:
+        {
+            bool equal = Interpreter::isEqual(stack[stack.size() - 2], stack.back());
+            stack.pop_back();
+            stack.back() = Value(equal);
+            break;
+        }
+        case OpCode::NOT_EQUAL:
+        {
+            bool equal = Interpreter::isEqual(stack[stack.size() - 2], stack.back());
+            stack.pop_back();
+            stack.back() = Value(!equal);
+            break;
+        }
+        case OpCode::GREATER:
+            NUMBER_OP(>);
+            break;
+        case OpCode::GREATER_EQUAL:
+            NUMBER_OP(>=);
+            break;
+        case OpCode::LESS:
+            NUMBER_OP(<);
+            break;
+        case OpCode::LESS_EQUAL:
+            NUMBER_OP(<=);
+            break;
+        case OpCode::ADD:
+        {
+            const Value &right = stack.back();
+            const Value &left = stack[stack.size() - 2];
+            Value result;
+
+            if (left.isNumber() && right.isNumber())
+                result = Value(left.asNumber() + right.asNumber());
+            else if (left.isString() && right.isString())
+                result = Heap::instance().concat(left, right);
+            else
+                throw error("Operands must be two numbers or two strings.");
+
+            stack.pop_back();
+            stack.back() = result;
+            break;
+        }
+        case OpCode::SUBTRACT:
+            NUMBER_OP(-);
+            break;
+        case OpCode::MULTIPLY:
+            NUMBER_OP(*);
+            break;
+        case OpCode::DIVIDE:
+            NUMBER_OP(/);
+            break;
+        case OpCode::NOT:
+            stack.back() = Value(!Interpreter::isTruthy(stack.back()));
+            break;
+        case OpCode::NEGATE:
+            if (!stack.back().isNumber())
+                throw error("Operand must be a number.");
+
+            stack.back() = Value(-stack.back().asNumber());
+            break;
+        case OpCode::PRINT:
+            REPL::print(Interpreter::stringify(stack.back()));
+            stack.pop_back();
+            break;
+        case OpCode::JUMP:
+        {
+            uint16_t offset = READ_SHORT();
+            frame->ip += offset;
+            break;
+        }
+        case OpCode::JUMP_IF_FALSE:
+        {
+            uint16_t offset = READ_SHORT();
+
+            if (!Interpreter::isTruthy(stack.back()))
+                frame->ip += offset;
+            break;
+        }
+        case OpCode::LOOP:
+        {
+            uint16_t offset = READ_SHORT();
+            frame->ip -= offset;
+            break;
+        }
+        case OpCode::CALL:
+            call(READ_BYTE());
+            frame = &frames.back();
+            break;
+        case OpCode::TAIL_CALL:
+            tailCall(READ_BYTE());
+            frame = &frames.back();
+            break;
+        case OpCode::CLOSURE:
+        {
+            const Value &prototype = frame->closure->function()->chunk.constants[READ_SHORT()];
+            LoxClosure *closure = Heap::instance().allocate<LoxClosure>(prototype);
+            stack.push_back(Value(ValueType::CLOSURE, closure));
+
+            for (size_t i = 0; i < closure->upvalues.size(); i++)
+            {
+                uint8_t isLocal = READ_BYTE();
+                uint8_t index = READ_BYTE();
+
+                if (isLocal)
+                    closure->upvalues[i] = captureUpvalue(frame->base + index);
+                else
+                    closure->upvalues[i] = frame->closure->upvalues[index];
+            }
+            break;
+        }
+        case OpCode::CLOSE_UPVALUE:
+            closeUpvalues(stack.size() - 1);
+            stack.pop_back();
+            break;
+        case OpCode::RETURN:
+        {
+            Value result = stack.back();
+            size_t base = frame->base;
+
+            closeUpvalues(base);
+            frames.pop_back();
+            stack.resize(base);
+
+            if (frames.empty())
+                return;
+
+            stack.push_back(result);
+            frame = &frames.back();
+            break;
+        }
+        }
+    }
+
+#undef READ_BYTE
+#undef READ_SHORT
+#undef NUMBER_OP
+}
+
+/*
+PUBLIC
+*/
+
+// The script's own frame counts as one.
+void VM::setMaxDepth(size_t depth)
+{
+    maxFrames = depth + 1;
+}
+
+int VM::globalSlot(const std::string &name)
+{
+    auto search = globalSlots.find(name);
+
+    if (search != globalSlots.end())
+        return search->second;
+
+    int slot = globalNames.size();
+    globalSlots[name] = slot;
+    globalNames.push_back(name);
+    globalValues.push_back(Value());
+    globalDefined.push_back(false);
+
+    return slot;
+}
+
+void VM::interpret(const Value &script)
+{
+    // The script stays on the stack while its closure is allocated.
+    stack.push_back(script);
+    LoxClosure *closure = Heap::instance().allocate<LoxClosure>(script);
+    stack.back() = Value(ValueType::CLOSURE, closure);
+    frames.push_back(CallFrame{closure, closure->function()->chunk.code.data(), 0});
+
+    try
+    {
+        run();
+    }
+    catch (RuntimeError &error)
+    {
+        REPL::runtimeError(error);
+        resetStack();
+    }
+}
+
+void VM::markRoots(Heap &heap) const
+{
+    for (const Value &value : stack)
+        heap.mark(value);
+
+    for (const CallFrame &frame : frames)
+        heap.mark(frame.closure);
+
+    for (LoxUpvalue *upvalue = openUpvalues; upvalue != nullptr; upvalue = upvalue->nextOpen)
+        heap.mark(upvalue);
+
+    for (const Value &value : globalValues)
+        heap.mark(value);
+}
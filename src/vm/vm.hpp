@@ -0,0 +1,59 @@
+#ifndef _VM_HPP
+#define _VM_HPP
+
+#include <ast/value.hpp>
+#include <vm/chunk.hpp>
+#include <vm/closure.hpp>
+#include <interpreter/interpreter.hpp>
+#include <heap/heap.hpp>
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+namespace Lox
+{
+    class VM : public RootSet
+    {
+    private:
+        struct CallFrame
+        {
+            LoxClosure *closure;
+            const uint8_t *ip;
+            size_t base;
+        };
+
+        static const size_t FRAMES_MAX = 8192;
+
+        std::vector<Value> stack;
+        std::vector<CallFrame> frames;
+        size_t maxFrames;
+        LoxUpvalue *openUpvalues;
+
+        // Globals are bound to slots at compile time, by name.
+        std::unordered_map<std::string, int> globalSlots;
+        std::vector<std::string> globalNames;
+        std::vector<Value> globalValues;
+        std::vector<bool> globalDefined;
+
+        void defineNative(const std::string &name, const Value &value);
+        void resetStack(void);
+        RuntimeError error(const std::string &message) const;
+        void call(int argCount);
+        void tailCall(int argCount);
+        LoxUpvalue *captureUpvalue(size_t slot);
+        void closeUpvalues(size_t last);
+        Value &upvalueValue(LoxUpvalue &upvalue);
+        void run(void);
+
+    public:
+        VM(void);
+        ~VM(void);
+        void setMaxDepth(size_t depth);
+        int globalSlot(const std::string &name);
+        void interpret(const Value &script);
+        void markRoots(Heap &heap) const override;
+    };
+}
+
+#endif